@@ -0,0 +1,248 @@
+#ifndef BATCH_GCD_HPP
+#define BATCH_GCD_HPP
+
+// Standard C/C++
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Internal
+#include "../utils/Exec_utils.hpp"
+#include "../utils/File_utils.hpp"
+#include "../utils/Math_utils.hpp"
+
+namespace crypto
+{
+namespace algos
+{
+// Spilled product tree level:
+//   count (8 bytes) | per number: limb count (8 bytes), limbs
+// Limbs are in native order. The files only live for one Batch_GCD call on this machine.
+static inline bool
+Write_Batch_GCD_Level(const std::string& path, const std::vector<mpz_class>& level)
+{
+    std::size_t size = sizeof(std::uint64_t);
+    for (const auto& number : level)
+    {
+        size += sizeof(std::uint64_t) + mpz_size(number.get_mpz_t()) * sizeof(mp_limb_t);
+    }
+
+    auto out = file::MappedFile::create(path, size);
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    std::uint8_t* position = out.data();
+    const std::uint64_t count = level.size();
+    std::memcpy(position, &count, sizeof(count));
+    position += sizeof(count);
+
+    for (const auto& number : level)
+    {
+        const std::uint64_t limbs = mpz_size(number.get_mpz_t());
+        std::memcpy(position, &limbs, sizeof(limbs));
+        position += sizeof(limbs);
+
+        if (limbs > 0)
+        {
+            std::memcpy(position, mpz_limbs_read(number.get_mpz_t()), limbs * sizeof(mp_limb_t));
+        }
+        position += limbs * sizeof(mp_limb_t);
+    }
+
+    return out.sync();
+}
+
+static inline bool
+Read_Batch_GCD_Level(const std::string& path, std::vector<mpz_class>& level)
+{
+    const auto in = file::MappedFile::open_read(path);
+    if (!in.is_open() || in.size() < sizeof(std::uint64_t))
+    {
+        return false;
+    }
+
+    const std::uint8_t* position = in.data();
+    const std::uint8_t* end      = in.data() + in.size();
+
+    std::uint64_t count = 0;
+    std::memcpy(&count, position, sizeof(count));
+    position += sizeof(count);
+
+    level.resize(count);
+    for (auto& number : level)
+    {
+        std::uint64_t limbs = 0;
+        if (static_cast<std::size_t>(end - position) < sizeof(limbs))
+        {
+            return false;
+        }
+        std::memcpy(&limbs, position, sizeof(limbs));
+        position += sizeof(limbs);
+
+        if (limbs > static_cast<std::size_t>(end - position) / sizeof(mp_limb_t))
+        {
+            return false;
+        }
+
+        mp_limb_t* destination = mpz_limbs_write(number.get_mpz_t(), static_cast<mp_size_t>(std::max<std::uint64_t>(limbs, 1)));
+        if (limbs > 0)
+        {
+            std::memcpy(destination, position, limbs * sizeof(mp_limb_t));
+        }
+        mpz_limbs_finish(number.get_mpz_t(), static_cast<mp_size_t>(limbs));
+        position += limbs * sizeof(mp_limb_t);
+    }
+
+    return true;
+}
+
+//! @description: One level up the product tree: neighbours multiplied in pairs, in parallel.
+//!               An odd node at the end moves up unchanged.
+static inline std::vector<mpz_class>
+Product_Tree_Level(const std::vector<mpz_class>& level)
+{
+    std::vector<mpz_class> parents((level.size() + 1) / 2);
+    crypto::exec::parallel_for(0, parents.size(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        for (std::uint64_t i = first; i < last; ++i)
+        {
+            if (2 * i + 1 < level.size())
+            {
+                mpz_mul(parents[i].get_mpz_t(), level[2 * i].get_mpz_t(), level[2 * i + 1].get_mpz_t());
+            }
+            else
+            {
+                parents[i] = level[2 * i];
+            }
+        }
+    });
+
+    return parents;
+}
+
+//! @description: Bernstein's batch GCD. Finds every modulus that shares a prime with another one in
+//!               quasi-linear time, instead of comparing every pair.
+//!               1. Product tree: the product P of all moduli, built level by level.
+//!               2. Remainder tree: going back down, every node keeps P mod node^2.
+//!               3. At a leaf N, gcd(N, (P mod N^2) / N) is the part of N shared with the others.
+//!               Every level is computed in parallel on the exec pool.
+//!               With a spill directory, finished product tree levels are written there and read
+//!               back on the way down, so only about two levels are in memory at a time. The files
+//!               are removed again. Don't run two batches on the same directory at once.
+//! @params: moduli:          RSA moduli, all > 1
+//!          shared:          {index, gcd} for every modulus with a shared factor. The gcd is the
+//!                           modulus itself when both of its primes are shared (or it is duplicated).
+//!          spill_directory: empty to keep the whole tree in memory
+//! @return false if a spilled level could not be written or read back.
+static inline bool
+Batch_GCD(const std::vector<mpz_class>&                   moduli,
+          std::vector<std::pair<std::size_t, mpz_class>>& shared,
+          const std::string&                              spill_directory = "")
+{
+    shared.clear();
+    if (moduli.size() < 2)
+    {
+        return true;
+    }
+
+    const bool spill = !spill_directory.empty();
+    const auto level_path = [&](const std::size_t k)
+    {
+        return spill_directory + "/batch_gcd_level_" + std::to_string(k) + ".bin";
+    };
+
+    // levels[0] is the moduli themselves and stays with the caller.
+    std::vector<std::vector<mpz_class>> levels(1);
+    std::size_t depth = 0;
+    const std::vector<mpz_class>* current = &moduli;
+    while (current->size() > 1)
+    {
+        levels.push_back(Product_Tree_Level(*current));
+        ++depth;
+
+        if (spill && depth > 1)
+        {
+            if (!Write_Batch_GCD_Level(level_path(depth - 1), levels[depth - 1]))
+            {
+                for (std::size_t j = 1; j < depth; ++j)
+                {
+                    std::remove(level_path(j).c_str());
+                }
+                return false;
+            }
+            std::vector<mpz_class>().swap(levels[depth - 1]);
+        }
+        current = &levels[depth];
+    }
+
+    // The root is P, and P mod P^2 = P.
+    std::vector<mpz_class> remainders(std::move(levels[depth]));
+    std::vector<mpz_class> next;
+    for (std::size_t k = depth; k-- > 0;)
+    {
+        if (spill && k > 0)
+        {
+            const bool read = Read_Batch_GCD_Level(level_path(k), levels[k]);
+            std::remove(level_path(k).c_str());
+            if (!read)
+            {
+                // Don't leave the rest of the tree behind.
+                for (std::size_t j = 1; j < k; ++j)
+                {
+                    std::remove(level_path(j).c_str());
+                }
+                return false;
+            }
+        }
+
+        const std::vector<mpz_class>& nodes = k == 0 ? moduli : levels[k];
+        next.resize(nodes.size());
+        crypto::exec::parallel_for(0, nodes.size(), [&](const std::uint64_t first, const std::uint64_t last)
+        {
+            mpz_class square{};
+            for (std::uint64_t i = first; i < last; ++i)
+            {
+                mpz_mul(square.get_mpz_t(), nodes[i].get_mpz_t(), nodes[i].get_mpz_t());
+                mpz_mod(next[i].get_mpz_t(), remainders[i / 2].get_mpz_t(), square.get_mpz_t());
+            }
+        });
+
+        remainders.swap(next);
+        if (k > 0)
+        {
+            std::vector<mpz_class>().swap(levels[k]);
+        }
+    }
+
+    // remainders[i] = P mod N_i^2, always a multiple of N_i.
+    std::vector<mpz_class> divisors(moduli.size());
+    crypto::exec::parallel_for(0, moduli.size(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        for (std::uint64_t i = first; i < last; ++i)
+        {
+            mpz_divexact(remainders[i].get_mpz_t(), remainders[i].get_mpz_t(), moduli[i].get_mpz_t());
+            divisors[i] = math::gcd(remainders[i], moduli[i]);
+        }
+    });
+
+    for (std::size_t i = 0; i < divisors.size(); ++i)
+    {
+        if (divisors[i] != 1)
+        {
+            shared.emplace_back(i, std::move(divisors[i]));
+        }
+    }
+
+    return true;
+}
+
+} // namespace algos
+} // namespace crypto
+#endif // BATCH_GCD_HPP
@@ -70,14 +70,15 @@ Diffie_Hellman_Key_Exchange_EC(const mpz_class A_priv_key,
     // X_a = Alice's Private Key
     // X_b = Bob's Private Key
     // Calculate Public Keys
-    auto Pub_A = math::Scalar_mult_points_to_ECC(generator, A_priv_key, modulo, a);
-    auto Pub_B = math::Scalar_mult_points_to_ECC(generator, B_priv_key, modulo, a);
+    const math::EllipticCurve curve(modulo, a, generator);
+    auto Pub_A = curve.multiply_generator(A_priv_key);
+    auto Pub_B = curve.multiply_generator(B_priv_key);
 
     std::cout << "Pub_A = " << Pub_A.first << "\t" << Pub_A.second << std::endl;
     std::cout << "Pub_B = " << Pub_B.first << "\t" << Pub_B.second << std::endl;
     // Now we can calculate the shared key
-    auto SK_A = math::Scalar_mult_points_to_ECC(Pub_B, A_priv_key, modulo, a);
-    auto SK_B = math::Scalar_mult_points_to_ECC(Pub_A, B_priv_key, modulo, a);
+    auto SK_A = curve.multiply(Pub_B, A_priv_key);
+    auto SK_B = curve.multiply(Pub_A, B_priv_key);
 
     std::cout << "SK_A = " << SK_A.first << "\t" << SK_A.second << std::endl;
     std::cout << "SK_B = " << SK_B.first << "\t" << SK_B.second << std::endl;
@@ -3,13 +3,17 @@
 
 // Standard C/C++
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 // Internal
 #include "../utils/Message_utils.hpp"
 #include "../utils/Crypto_utils.hpp"
+#include "../utils/Random_utils.hpp"
 
 namespace crypto
 {
@@ -71,12 +75,9 @@ ElGamal_Encrypt(const std::uint64_t a,
     // Calculate Ciphertext.
     // A uses B's public key to encrypt. Therefore it is used in the mask calculation.
     // A also uses its secret key (exponent) in the mask calculation
+    const math::ModularRing ring(modulo);
     mpz_class ciphertext{};
-    mpz_class ciphertext_base = mask * compressed_num_plaintext;
-    mpz_powm_ui(ciphertext.get_mpz_t(),      // Result buffer
-                ciphertext_base.get_mpz_t(), // Base
-                1,                           // Exponent
-                modulo.get_mpz_t());         // Modulo
+    ring.mul(ciphertext, mask, compressed_num_plaintext);
 
     std::cout << "ciphertext = " << ciphertext << std::endl;
 
@@ -146,12 +147,9 @@ ElGamal_Encrypt(const std::uint64_t a,
     // Calculate Ciphertext.
     // A uses B's public key to encrypt. Therefore it is used in the mask calculation.
     // A also uses its secret key (exponent) in the mask calculation
+    const math::ModularRing ring(modulo);
     mpz_class ciphertext{};
-    const mpz_class ciphertext_base = mask * numeric_message;
-    mpz_powm_ui(ciphertext.get_mpz_t(),      // Result buffer
-                ciphertext_base.get_mpz_t(), // Base
-                1,                           // Exponent
-                modulo.get_mpz_t());         // Modulo
+    ring.mul(ciphertext, mask, mpz_class(numeric_message));
     
     std::cout << "ciphertext = " << ciphertext << std::endl;
 
@@ -208,17 +206,603 @@ ElGamal_Decrypt(const std::uint64_t a,
     mpz_class decryption{};
 
     // Decryption: Ciphertext * R mod p
-    const mpz_class decrypt_base = params.first.first * R;
-    mpz_powm_ui(decryption.get_mpz_t(),   // Result buffer
-                decrypt_base.get_mpz_t(), // Base
-                1,                        // Exponent
-                modulo.get_mpz_t());      // Modulo
+    const math::ModularRing ring(modulo);
+    ring.mul(decryption, params.first.first, R);
 
     std::cout << "decryption (inside function) = " <<  decryption << std::endl;
 
     return decryption;
 }
 
+//! @description: ElGamal encryption to one receiver, set up once.
+//!               The receiver's public key, the group and the fixed-base tables for g and PK_B are
+//!               built in the constructor, so an encryption only does the per-message work.
+//!               The secret keys k are drawn from the OS entropy pool (crypto::random).
+//!               Nothing is printed. All methods are const and the object is never modified after
+//!               construction, so one encryptor can be used from many threads at once.
+class ElGamalEncryptor
+{
+public:
+    using Ciphertext = std::pair<mpz_class, mpz_class>; // {ciphertext, hint}
+
+    //! @params: PK_B:      public key of the receiver (g^b mod p)
+    //!          generator: fixed-base table of g over p
+    ElGamalEncryptor(const mpz_class& PK_B, const math::FixedBasePow& generator)
+        : generator_(generator),
+          receiver_(PK_B, generator.modulo()),
+          key_range_(generator.modulo() - 2),
+          block_size_(message::max_block_size(generator.modulo()))
+    {
+        assert(generator.modulo() > 2);
+        powers_.reserve(block_size_);
+    }
+
+    ElGamalEncryptor(const mpz_class& PK_B, const mpz_class& modulo, const mpz_class& generator)
+        : ElGamalEncryptor(PK_B, math::FixedBasePow(generator, modulo))
+    {
+    }
+
+    // From ElGamal_Key_Generation's {key, {generator, modulo}}.
+    explicit ElGamalEncryptor(const std::pair<mpz_class, std::pair<mpz_class, mpz_class>>& public_key)
+        : ElGamalEncryptor(public_key.first, public_key.second.second, public_key.second.first)
+    {
+    }
+
+    const mpz_class& modulo()     const { return generator_.modulo(); }
+    const mpz_class& generator()  const { return generator_.base(); }
+    const mpz_class& public_key() const { return receiver_.base(); }
+
+    const math::ModularRing& ring() const { return generator_.ring(); }
+
+    // Characters per block in encrypt_text(). 0 for p < 28, which can't hold a character.
+    std::size_t block_size() const { return block_size_; }
+
+    //! @description: Encrypt with a caller chosen secret key k.
+    //! @return false if k is outside [1, p - 2] or gives a mask of 1. ciphertext is left alone then.
+    bool
+    encrypt(const mpz_class& numeric_message, const mpz_class& key, Ciphertext& ciphertext) const
+    {
+        if (key < 1 || key > key_range_)
+        {
+            return false;
+        }
+
+        mpz_class mask{};
+        receiver_.pow(mask, key);
+        if (mask == 1)
+        {
+            return false;
+        }
+
+        generator_.ring().mul(ciphertext.first, mask, numeric_message);
+        generator_.pow(ciphertext.second, key);
+        return true;
+    }
+
+    //! @description: The message independent half of an encryption: a fresh k in [1, p - 2],
+    //!               returned as hint = g^k and mask = PK_B^k. k is drawn again while the mask is 1,
+    //!               so a message is never sent in the clear.
+    void
+    ephemeral(mpz_class& hint, mpz_class& mask) const
+    {
+        mpz_class key{};
+        do
+        {
+            key = crypto::random::below(key_range_) + 1;
+            receiver_.pow(mask, key);
+        } while (mask == 1);
+
+        generator_.pow(hint, key);
+    }
+
+    //! @description: Encrypt with a fresh k, see ephemeral().
+    void
+    encrypt(const mpz_class& numeric_message, Ciphertext& ciphertext) const
+    {
+        mpz_class mask{};
+        ephemeral(ciphertext.second, mask);
+        generator_.ring().mul(ciphertext.first, mask, numeric_message);
+    }
+
+    Ciphertext
+    encrypt(const mpz_class& numeric_message) const
+    {
+        Ciphertext ciphertext{};
+        encrypt(numeric_message, ciphertext);
+        return ciphertext;
+    }
+
+    // Whether a character (as message::text_to_numeric gives it) goes into a text block.
+    // Zero would be lost as a leading digit, so only real characters do.
+    static bool
+    encodable(const std::uint8_t numeric)
+    {
+        return numeric != message::unmapped_numeric && numeric != 0;
+    }
+
+    //! @description: Encrypt text in blocks of block_size() characters, a fresh k for every block.
+    //!               Characters that aren't encodable() are skipped, the same as
+    //!               ElGamal_Encrypt_Stream.
+    //! @return Empty if p is too small to hold a single character (block_size() == 0).
+    std::vector<Ciphertext>
+    encrypt_text(const std::string& plaintext) const
+    {
+        if (block_size_ == 0)
+        {
+            return {};
+        }
+
+        std::vector<std::uint8_t> numeric = message::text_to_numeric(plaintext);
+        numeric.erase(std::remove_if(numeric.begin(), numeric.end(), [](const std::uint8_t n)
+        {
+            return !encodable(n);
+        }), numeric.end());
+
+        std::vector<Ciphertext> ciphertexts;
+        ciphertexts.reserve((numeric.size() + block_size_ - 1) / block_size_);
+
+        mpz_class compressed{};
+        for (std::size_t first = 0; first < numeric.size(); first += block_size_)
+        {
+            const std::size_t length = std::min(block_size_, numeric.size() - first);
+            message::digits_to_integer(compressed, numeric.data() + first, length, powers_);
+            ciphertexts.emplace_back(encrypt(compressed));
+        }
+
+        return ciphertexts;
+    }
+
+private:
+    const math::FixedBasePow generator_; // g
+    const math::FixedBasePow receiver_;  // PK_B
+    const mpz_class          key_range_;
+    const std::size_t        block_size_;
+    message::RadixPowers     powers_{};  // only read after construction
+};
+
+//! @description: ElGamal Encryption of a whole stream, one block at a time.
+//!               The plaintext is read in fixed size chunks, and each block is written as
+//!               "ciphertext hint" on its own line as soon as it is full, so memory use does not
+//!               depend on the length of the input.
+//!               Characters outside of the plaintext alphabet (and '\0') are skipped.
+//! @params: plaintext:  stream to encrypt
+//!          ciphertext: stream the blocks are written to
+//!          encryptor:  encryptor for the receiver. p must be large enough to hold at least one
+//!                      character per block
+//! @return The number of blocks written.
+static inline std::size_t
+ElGamal_Encrypt_Stream(std::istream&           plaintext,
+                       std::ostream&           ciphertext,
+                       const ElGamalEncryptor& encryptor)
+{
+    const std::size_t block_size = encryptor.block_size();
+    assert(block_size > 0);
+    if (block_size == 0)
+    {
+        return 0;
+    }
+
+    // Everything below is allocated once.
+    message::RadixPowers powers{};
+    powers.reserve(block_size);
+
+    constexpr std::size_t chunk_size = 4096;
+    std::vector<char>         chunk(chunk_size);
+    std::vector<std::uint8_t> numeric(chunk_size);
+    std::vector<std::uint8_t> block;
+    block.reserve(block_size);
+
+    mpz_class compressed{};
+    ElGamalEncryptor::Ciphertext encrypted{};
+
+    std::size_t blocks = 0;
+    const auto encrypt_block = [&]()
+    {
+        message::digits_to_integer(compressed, block.data(), block.size(), powers);
+        encryptor.encrypt(compressed, encrypted);
+
+        ciphertext << encrypted.first << ' ' << encrypted.second << '\n';
+        block.clear();
+        ++blocks;
+    };
+
+    while (plaintext)
+    {
+        plaintext.read(chunk.data(), chunk_size);
+        const auto count = static_cast<std::size_t>(plaintext.gcount());
+        message::text_to_numeric(chunk.data(), count, numeric.data());
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (!ElGamalEncryptor::encodable(numeric[i]))
+            {
+                continue;
+            }
+
+            block.push_back(numeric[i]);
+            if (block.size() == block_size)
+            {
+                encrypt_block();
+            }
+        }
+    }
+
+    // The last block is just shorter, no padding needed.
+    if (!block.empty())
+    {
+        encrypt_block();
+    }
+
+    return blocks;
+}
+
+//! @description: Same as above for a single stream. Builds the tables for g and PK_B first, which
+//!               pays for itself after a handful of blocks.
+static inline std::size_t
+ElGamal_Encrypt_Stream(std::istream&    plaintext,
+                       std::ostream&    ciphertext,
+                       const mpz_class& PK_B,
+                       const mpz_class& modulo,
+                       const mpz_class& generator)
+{
+    return ElGamal_Encrypt_Stream(plaintext, ciphertext, ElGamalEncryptor(PK_B, modulo, generator));
+}
+
+//! @description: ElGamal Decryption of a stream written by ElGamal_Encrypt_Stream.
+//!               Each "ciphertext hint" line is decrypted and written out before the next one is read.
+//! @params: ciphertext: stream of "ciphertext hint" lines
+//!          plaintext:  stream the decoded text is written to
+//!          b:          private key of the receiver
+//!          modulo:     p used for encryption
+//! @return The number of blocks read.
+static inline std::size_t
+ElGamal_Decrypt_Stream(std::istream&    ciphertext,
+                       std::ostream&    plaintext,
+                       const mpz_class& b,
+                       const mpz_class& modulo)
+{
+    message::RadixPowers powers{};
+    powers.reserve(message::integer_digits_bound(modulo, powers.base()));
+
+    std::vector<std::uint8_t> scratch;
+    std::vector<char> text(message::integer_digits_bound(modulo, powers.base()));
+
+    // Find q: p - 1 - b.
+    const mpz_class q(modulo - 1 - b);
+    const math::ModularRing ring(modulo);
+
+    mpz_class encrypted{};
+    mpz_class hint{};
+    mpz_class R{};
+    mpz_class decryption{};
+
+    std::size_t blocks = 0;
+    while (ciphertext >> encrypted >> hint)
+    {
+        // Decryption: Ciphertext * Hint^q mod p
+        ring.pow(R, hint, q);
+        ring.mul(decryption, encrypted, R);
+
+        const auto length = message::decode_naive_block(decryption, powers, scratch, text.data());
+        plaintext.write(text.data(), length);
+        ++blocks;
+    }
+
+    return blocks;
+}
+
+//! @description: Precomputed ephemeral values for ElGamal encryption to one receiver.
+//!               The expensive part of encryption doesn't depend on the message: for a fresh k,
+//!               hint = g^k and mask = PK_B^k. Background tasks on the exec pool keep a bounded
+//!               lock-free queue of {hint, mask} pairs full, so an encryption only pops a pair and
+//!               does one modular multiplication. When the queue runs dry the pair is computed on
+//!               the calling thread instead (counted in misses()).
+//!               Every pair is handed out exactly once. take() can be called from many threads.
+class ElGamalEphemeralPool
+{
+public:
+    struct Ephemeral
+    {
+        mpz_class hint; // g^k
+        mpz_class mask; // PK_B^k
+    };
+
+    //! @params: PK_B:      public key of the receiver (g^b mod p)
+    //!          generator: fixed-base table of g over p
+    //!          capacity:  pairs kept ready. A refill starts when the pool is half empty.
+    //! The secret keys k are drawn from the OS entropy pool.
+    ElGamalEphemeralPool(const mpz_class&           PK_B,
+                         const math::FixedBasePow&  generator,
+                         const std::size_t          capacity,
+                         crypto::exec::ThreadPool&  pool = crypto::exec::default_pool())
+        : encryptor_(PK_B, generator),
+          queue_(capacity),
+          low_water_(queue_.capacity() / 2),
+          group_(pool)
+    {
+        refill_async();
+    }
+
+    ElGamalEphemeralPool(const ElGamalEphemeralPool&) = delete;
+    ElGamalEphemeralPool& operator=(const ElGamalEphemeralPool&) = delete;
+
+    ~ElGamalEphemeralPool()
+    {
+        stopping_.store(true, std::memory_order_relaxed);
+        group_.wait();
+    }
+
+    const mpz_class& modulo() const { return encryptor_.modulo(); }
+
+    const ElGamalEncryptor& encryptor() const { return encryptor_; }
+
+    std::size_t capacity() const { return queue_.capacity(); }
+
+    // Pairs ready right now. Only a hint while encryptions are running.
+    std::size_t size() const { return queue_.size(); }
+
+    // Number of take() calls that found the pool empty.
+    std::size_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+    // Fill the pool on the calling thread, e.g. before the first request comes in.
+    void
+    fill()
+    {
+        while (refilling_.exchange(true, std::memory_order_acquire))
+        {
+            group_.wait();
+        }
+        refill();
+        refilling_.store(false, std::memory_order_release);
+    }
+
+    void
+    take(Ephemeral& ephemeral)
+    {
+        if (!queue_.try_pop(ephemeral))
+        {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            make(ephemeral);
+        }
+
+        if (queue_.size() < low_water_)
+        {
+            refill_async();
+        }
+    }
+
+private:
+    void
+    make(Ephemeral& ephemeral)
+    {
+        encryptor_.ephemeral(ephemeral.hint, ephemeral.mask);
+    }
+
+    void
+    refill()
+    {
+        Ephemeral ephemeral{};
+        while (!stopping_.load(std::memory_order_relaxed) && queue_.size() < queue_.capacity())
+        {
+            make(ephemeral);
+            if (!queue_.try_push(std::move(ephemeral)))
+            {
+                break;
+            }
+        }
+    }
+
+    // At most one refill task at a time.
+    void
+    refill_async()
+    {
+        if (stopping_.load(std::memory_order_relaxed) ||
+            refilling_.exchange(true, std::memory_order_acquire))
+        {
+            return;
+        }
+
+        group_.run([this]()
+        {
+            refill();
+            refilling_.store(false, std::memory_order_release);
+        });
+    }
+
+    const ElGamalEncryptor encryptor_;
+
+    crypto::exec::BoundedQueue<Ephemeral> queue_;
+    const std::size_t                     low_water_;
+    std::atomic<std::size_t>              misses_{ 0 };
+    std::atomic<bool>                     refilling_{ false };
+    std::atomic<bool>                     stopping_{ false };
+    crypto::exec::TaskGroup               group_;
+};
+
+//! @description: Online ElGamal Encryption with a precomputed ephemeral pair.
+//!               One modular multiplication, no exponentiation unless the pool is empty.
+//! @params: numeric_message: encoded message, 0 < message < p
+//!          ephemerals:      pool for the receiver
+//! @return {ciphertext, hint}
+static inline std::pair<mpz_class, mpz_class>
+ElGamal_Encrypt(const mpz_class&      numeric_message,
+                ElGamalEphemeralPool& ephemerals)
+{
+    ElGamalEphemeralPool::Ephemeral ephemeral{};
+    ephemerals.take(ephemeral);
+
+    mpz_class ciphertext{};
+    ephemerals.encryptor().ring().mul(ciphertext, ephemeral.mask, numeric_message);
+
+    return std::make_pair(std::move(ciphertext), std::move(ephemeral.hint));
+}
+
+//! @description: ElGamal decryption for one receiver, set up once.
+//!               Keeps p and the exponent p - 1 - b. Nothing is printed, and all methods are const,
+//!               so one decryptor can be used from many threads at once.
+class ElGamalDecryptor
+{
+public:
+    using Ciphertext = ElGamalEncryptor::Ciphertext;
+
+    //! @params: b:      private key of the receiver
+    //!          modulo: p
+    ElGamalDecryptor(const mpz_class& b, const mpz_class& modulo)
+        : ring_(modulo),
+          key_(b),
+          exponent_(modulo - 1 - b)
+    {
+        assert(b > 0 && b < modulo - 1);
+        powers_.reserve(message::integer_digits_bound(modulo, powers_.base()));
+    }
+
+    const mpz_class& modulo() const { return ring_.modulo(); }
+
+    // Decryption: Ciphertext * Hint^(p - 1 - b) mod p
+    void
+    decrypt(mpz_class& plain, const Ciphertext& ciphertext) const
+    {
+        ring_.pow(plain, ciphertext.second, exponent_);
+        ring_.mul(plain, plain, ciphertext.first);
+    }
+
+    mpz_class
+    decrypt(const Ciphertext& ciphertext) const
+    {
+        mpz_class plain{};
+        decrypt(plain, ciphertext);
+        return plain;
+    }
+
+    //! @description: Decrypt many ciphertexts at once, spread over the thread pool.
+    //!               Every hint^b is computed in parallel, then all of them are inverted together
+    //!               with one modular inversion (math::Batch_Inverse), so a plaintext is
+    //!               Ciphertext * (Hint^b)^-1 mod p.
+    //!               A hint that isn't invertible mod p (e.g. 0) can't come from a real encryption.
+    //!               It is set aside before the inversion, so it only fails its own ciphertext.
+    //! @params: plains:    decrypted numbers, in the same order. 0 where decryption failed
+    //!          decrypted: decrypted[i] is false if ciphertexts[i] has a bad hint
+    //! @return The number of ciphertexts decrypted.
+    std::size_t
+    decrypt_batch(const std::vector<Ciphertext>& ciphertexts,
+                  std::vector<mpz_class>&        plains,
+                  std::vector<bool>&             decrypted) const
+    {
+        plains.resize(ciphertexts.size());
+        crypto::exec::parallel_for(0, ciphertexts.size(), [&](const std::uint64_t first, const std::uint64_t last)
+        {
+            for (std::uint64_t i = first; i < last; ++i)
+            {
+                ring_.pow(plains[i], ciphertexts[i].second, key_);
+            }
+        });
+
+        // Only p's multiples are lost when p is prime. Otherwise a non-unit still fails the batch,
+        // and the inverses are taken one at a time to find it.
+        std::vector<std::size_t> units;
+        std::vector<mpz_class>   inverses;
+        units.reserve(ciphertexts.size());
+        inverses.reserve(ciphertexts.size());
+        for (std::size_t i = 0; i < plains.size(); ++i)
+        {
+            if (plains[i] != 0)
+            {
+                units.push_back(i);
+                inverses.push_back(plains[i]);
+            }
+        }
+
+        if (!math::Batch_Inverse(inverses, modulo()))
+        {
+            mpz_class inverse{};
+            std::size_t next = 0;
+            for (std::size_t j = 0; j < units.size(); ++j)
+            {
+                if (math::Inverse_Modulo(inverse, inverses[j], modulo()))
+                {
+                    units[next] = units[j];
+                    inverses[next++] = inverse;
+                }
+            }
+            units.resize(next);
+            inverses.resize(next);
+        }
+
+        decrypted.assign(ciphertexts.size(), false);
+        for (const auto i : units)
+        {
+            decrypted[i] = true;
+        }
+
+        crypto::exec::parallel_for(0, units.size(), [&](const std::uint64_t first, const std::uint64_t last)
+        {
+            for (std::uint64_t j = first; j < last; ++j)
+            {
+                ring_.mul(plains[units[j]], inverses[j], ciphertexts[units[j]].first);
+            }
+        });
+
+        for (std::size_t i = 0; i < plains.size(); ++i)
+        {
+            if (!decrypted[i])
+            {
+                plains[i] = 0;
+            }
+        }
+
+        return units.size();
+    }
+
+    //! @return false if any hint isn't invertible mod p. The other ciphertexts are still decrypted.
+    bool
+    decrypt_batch(const std::vector<Ciphertext>& ciphertexts, std::vector<mpz_class>& plains) const
+    {
+        std::vector<bool> decrypted;
+        return decrypt_batch(ciphertexts, plains, decrypted) == ciphertexts.size();
+    }
+
+    // Blocks written by ElGamalEncryptor::encrypt_text.
+    std::string
+    decrypt_text(const std::vector<Ciphertext>& ciphertexts) const
+    {
+        const std::size_t bound = message::integer_digits_bound(modulo(), powers_.base());
+        std::string text(ciphertexts.size() * bound, '\0');
+        std::vector<std::uint8_t> scratch;
+
+        mpz_class plain{};
+        std::size_t length = 0;
+        for (const auto& ciphertext : ciphertexts)
+        {
+            decrypt(plain, ciphertext);
+            length += message::decode_naive_block(plain, powers_, scratch, &text[length]);
+        }
+        text.resize(length);
+
+        return text;
+    }
+
+private:
+    const math::ModularRing ring_;     // p
+    const mpz_class         key_;      // b
+    const mpz_class         exponent_; // p - 1 - b
+    message::RadixPowers    powers_{};
+};
+
+//! @description: Batch ElGamal Decryption of many {Ciphertext, Hint} pairs for the same receiver.
+//! @params: ciphertexts: {Ciphertext, Hint} pairs
+//!          b:           private key of the receiver, any size
+//!          modulo:      p used for encryption
+//!          plains:      decrypted numbers, in the same order. 0 where decryption failed
+//! @return false if a hint isn't invertible mod p. The other ciphertexts are still decrypted.
+static inline bool
+ElGamal_Decrypt_Batch(const std::vector<std::pair<mpz_class, mpz_class>>& ciphertexts,
+                      const mpz_class&                                    b,
+                      const mpz_class&                                    modulo,
+                      std::vector<mpz_class>&                             plains)
+{
+    return ElGamalDecryptor(b, modulo).decrypt_batch(ciphertexts, plains);
+}
+
 //! @description: ElGamal Public Key Generation for the sender (Digital Signatures)
 //! @params: secret_key: r in the equation, a random integer such that 0 < r < p - 1
 //!          modulo
@@ -229,16 +813,27 @@ ElGamal_Key_Generation(const mpz_class& secret_key,
 {
     assert(secret_key > 0 && secret_key < modulo - 1);
 
-    mpz_class key{};
-    mpz_class generator(math::find_smallest_generator(modulo));
-    mpz_powm_ui(key.get_mpz_t(),       // Result buffer
-                generator.get_mpz_t(), // Base
-                secret_key.get_ui(),   // Exponent
-                modulo.get_mpz_t());   // Modulo
+    const mpz_class generator(math::find_smallest_generator(modulo));
+    const math::ModularRing ring(modulo);
+    const mpz_class key(math::ModInt(ring, generator).pow(secret_key).value());
 
     return std::make_pair(key, std::make_pair(generator, modulo));
 }
 
+//! @description: ElGamal Public Key Generation with a precomputed table for the generator.
+//! @params: secret_key: r in the equation, a random integer such that 0 < r < p - 1
+//!          generator:  fixed-base table of g over the modulo
+//! @return {key}, {generator, modulo}
+static inline std::pair<mpz_class, std::pair<mpz_class, mpz_class>> 
+ElGamal_Key_Generation(const mpz_class&          secret_key,
+                       const math::FixedBasePow& generator)
+{
+    assert(secret_key > 0 && secret_key < generator.modulo() - 1);
+
+    return std::make_pair(generator.pow(secret_key),
+                          std::make_pair(generator.base(), generator.modulo()));
+}
+
 //! @description: ElGamal Signing to sign message M
 //! @params: R: different secret key from key generation, 0 < R < modulo - 1 and coprime to modulo - 1
 //!          r: secret key used for key generation
@@ -253,40 +848,65 @@ ElGamal_Sign(const mpz_class& R, // Different Secret Key
              const mpz_class& modulo,
              const mpz_class& generator)
 {
-    // VERY IMPORTANT.
-    assert(math::is_coprime(R, mpz_class(modulo - 1)));
+    // VERY IMPORTANT: R has to be coprime to modulo - 1.
+    const math::ModularRing exponents(modulo - 1);
+    mpz_class R_inverse_value{};
+    const bool invertible = exponents.inverse(R_inverse_value, R);
+    assert(invertible);
+    (void)invertible;
 
     // Find X = g^R mod p
-    mpz_class X{};
-    mpz_powm_ui(X.get_mpz_t(),         // Result buffer
-                generator.get_mpz_t(), // Base
-                R.get_ui(),            // Exponent
-                modulo.get_mpz_t());   // Modulo
-
+    const math::ModularRing ring(modulo);
+    const math::ModInt g(ring, generator);
+    const mpz_class X(g.pow(R).value());
 
     // Find Y, so message = rX + RY mod modulo-1
     // Rewritten as Y = (M - rX) * R^-1 modulo-1
-    mpz_class Y{};
-    mpz_class R_inverse(math::Multiplicative_Inverse(R, modulo - 1));
-    mpz_class base((message - (r * X)) * R_inverse);
-    mpz_class p(modulo - 1);
-    mpz_powm_ui(Y.get_mpz_t(),    // Result buffer
-                base.get_mpz_t(), // Base
-                1,                // Exponent
-                p.get_mpz_t());   // Modulo
+    const math::ModInt R_inverse(exponents, R_inverse_value);
+    const math::ModInt Y_mod((math::ModInt(exponents, message) - math::ModInt(exponents, r) * math::ModInt(exponents, X)) * R_inverse);
+    const mpz_class Y(Y_mod.value());
     
     // Calculate Public Key K to be used for verification.
     // g^r
-    mpz_class K{};
-    mpz_powm_ui(K.get_mpz_t(),        // Result buffer
-               generator.get_mpz_t(), // Base
-               r.get_ui(),            // Exponent
-               modulo.get_mpz_t());   // Modulo
+    const mpz_class K(g.pow(r).value());
 
     return std::make_pair(std::make_pair(message, K),
                           std::make_pair(X, Y));
 }
 
+//! @description: ElGamal Signing with a precomputed table for the generator.
+//!               X = g^R and K = g^r both come from the table.
+//! @params: R: different secret key from key generation, 0 < R < modulo - 1 and coprime to modulo - 1
+//!          r: secret key used for key generation
+//!          message:
+//!          generator: fixed-base table of g over the modulo
+//! @return {message, Public Key}, {X, Y}}
+static inline std::pair<std::pair<mpz_class, mpz_class>, std::pair<mpz_class, mpz_class>> 
+ElGamal_Sign(const mpz_class&          R, // Different Secret Key
+             const mpz_class&          r,
+             const mpz_class&          message,
+             const math::FixedBasePow& generator)
+{
+    // VERY IMPORTANT: R has to be coprime to modulo - 1.
+    const math::ModularRing exponents(generator.modulo() - 1);
+    mpz_class R_inverse_value{};
+    const bool invertible = exponents.inverse(R_inverse_value, R);
+    assert(invertible);
+    (void)invertible;
+
+    // Find X = g^R mod p
+    const mpz_class X(generator.pow(R));
+
+    // Y = (M - rX) * R^-1 mod modulo-1
+    const math::ModInt R_inverse(exponents, R_inverse_value);
+    const math::ModInt Y_mod((math::ModInt(exponents, message) - math::ModInt(exponents, r) * math::ModInt(exponents, X)) * R_inverse);
+    const mpz_class Y(Y_mod.value());
+
+    // Public Key K = g^r, used for verification.
+    return std::make_pair(std::make_pair(message, generator.pow(r)),
+                          std::make_pair(X, Y));
+}
+
 //! @description: ElGamal Verification to verify message M
 //! @params: public_key: public key of the sender
 //!          X: param1
@@ -303,36 +923,23 @@ ElGamal_Verify(const mpz_class& public_key, // public key of the sender
                const mpz_class& modulo,
                const mpz_class& generator)
 {
-    // We want to solve (K^X)(K^Y) mod p
-    mpz_class K_X{};
-    mpz_pow_ui(K_X.get_mpz_t(),        // Result buffer
-               public_key.get_mpz_t(), // Base
-               X.get_ui());            // Exponent
+    // We want to solve (K^X)(X^Y) mod p, reduced at every step instead of building K^X and X^Y
+    // in full.
+    const math::ModularRing ring(modulo);
+    const math::ModInt K_X(math::ModInt(ring, public_key).pow(X));
     // std::cout << "K^X = " << K_X << std::endl;
 
     // X^Y
-    mpz_class X_Y{};
-    mpz_pow_ui(X_Y.get_mpz_t(), // Result buffer
-               X.get_mpz_t(),   // Base
-               Y.get_ui());     // Exponent
+    const math::ModInt X_Y(math::ModInt(ring, X).pow(Y));
 
     // std::cout << "X^Y = " << X_Y << std::endl;
 
-    mpz_class base(K_X * X_Y);
-    mpz_class result{};
-    mpz_powm_ui(result.get_mpz_t(),  // Result buffer
-                base.get_mpz_t(),    // Base
-                1,                   // Exponent
-                modulo.get_mpz_t()); // Modulo
+    const mpz_class result(math::ModInt(K_X * X_Y).value());
 
     std::cout << "ElGamal_Verify, A = " << result << std::endl;
 
     // Calculate verification
-    mpz_class verification{};
-    mpz_powm_ui(verification.get_mpz_t(), // Result buffer
-                generator.get_mpz_t(),    // Base
-                message.get_ui(),         // Exponent
-                modulo.get_mpz_t());      // Modulo
+    const mpz_class verification(math::ModInt(ring, generator).pow(message).value());
 
 
     std::cout << "Verification g^m mod p = " << verification << std::endl;
@@ -0,0 +1,363 @@
+#ifndef FILE_ENCRYPTION_HPP
+#define FILE_ENCRYPTION_HPP
+
+// Standard C/C++
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Internal
+#include "../utils/Exec_utils.hpp"
+#include "../utils/File_utils.hpp"
+#include "../utils/Math_utils.hpp"
+#include "../utils/Message_utils.hpp"
+#include "ElGamal.hpp"
+
+namespace crypto
+{
+namespace algos
+{
+// Encrypted file layout (all integers little endian):
+//   magic "CS608ENC" | version (1 byte) | algorithm (1 byte) | 2 reserved bytes
+//   plaintext bytes per block (4 bytes) | ciphertext bytes per number (4 bytes)
+//   plaintext length (8 bytes)
+// followed by one fixed size record per block: RSA = {c}, ElGamal = {c, hint}.
+// Every record has the same size, so each block can be read and written independently.
+static constexpr char          File_Encryption_Magic[8]  = { 'C', 'S', '6', '0', '8', 'E', 'N', 'C' };
+static constexpr std::uint8_t  File_Encryption_Version   = 1;
+static constexpr std::uint8_t  File_Encryption_RSA       = 1;
+static constexpr std::uint8_t  File_Encryption_ElGamal   = 2;
+static constexpr std::size_t   File_Encryption_Header    = 32;
+
+struct File_Encryption_Info
+{
+    std::uint8_t  algorithm    = 0;
+    std::uint32_t block_bytes  = 0; // plaintext bytes per block
+    std::uint32_t number_bytes = 0; // bytes per ciphertext number
+    std::uint64_t length       = 0; // plaintext length
+
+    std::size_t numbers_per_block() const
+    {
+        return algorithm == File_Encryption_ElGamal ? 2 : 1;
+    }
+
+    std::uint64_t blocks() const
+    {
+        return (length + block_bytes - 1) / block_bytes;
+    }
+
+    std::uint64_t encrypted_size() const
+    {
+        return File_Encryption_Header + blocks() * numbers_per_block() * number_bytes;
+    }
+};
+
+static inline void
+Write_File_Encryption_Header(const File_Encryption_Info& info, std::uint8_t* out)
+{
+    std::memset(out, 0, File_Encryption_Header);
+    std::memcpy(out, File_Encryption_Magic, sizeof(File_Encryption_Magic));
+    out[8] = File_Encryption_Version;
+    out[9] = info.algorithm;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        out[12 + i] = static_cast<std::uint8_t>(info.block_bytes >> (8 * i));
+        out[16 + i] = static_cast<std::uint8_t>(info.number_bytes >> (8 * i));
+    }
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        out[20 + i] = static_cast<std::uint8_t>(info.length >> (8 * i));
+    }
+}
+
+// Returns false if the file isn't an encrypted file of the expected algorithm and modulo.
+static inline bool
+Read_File_Encryption_Header(const file::MappedFile& in,
+                            const std::uint8_t      algorithm,
+                            const mpz_class&        modulo,
+                            File_Encryption_Info&   info)
+{
+    if (in.size() < File_Encryption_Header ||
+        std::memcmp(in.data(), File_Encryption_Magic, sizeof(File_Encryption_Magic)) != 0 ||
+        in.data()[8] != File_Encryption_Version ||
+        in.data()[9] != algorithm)
+    {
+        std::cerr << "Not an encrypted file of this type." << std::endl;
+        return false;
+    }
+
+    const std::uint8_t* header = in.data();
+    info.algorithm = algorithm;
+    info.block_bytes = 0;
+    info.number_bytes = 0;
+    info.length = 0;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        info.block_bytes  |= static_cast<std::uint32_t>(header[12 + i]) << (8 * i);
+        info.number_bytes |= static_cast<std::uint32_t>(header[16 + i]) << (8 * i);
+    }
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        info.length |= static_cast<std::uint64_t>(header[20 + i]) << (8 * i);
+    }
+
+    if (info.block_bytes  != message::max_byte_block_size(modulo) ||
+        info.number_bytes != message::byte_width(modulo) ||
+        info.block_bytes == 0 ||
+        in.size() != info.encrypted_size())
+    {
+        std::cerr << "Encrypted file does not match the modulo." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//! @description: Shared driver for the file encryption functions.
+//!               Maps the input, pre-sizes and maps the output, then hands every block and its
+//!               output record to encrypt_block. Each chunk of blocks gets its own
+//!               encrypt_block State for its temporaries.
+//!               The input and output must be different files: the output is truncated while the
+//!               input is still mapped.
+template<typename Function>
+static inline bool
+Encrypt_File(const std::string& input_path,
+             const std::string& output_path,
+             const std::uint8_t algorithm,
+             const mpz_class&   modulo,
+             Function&&         encrypt_block)
+{
+    File_Encryption_Info info{};
+    info.algorithm    = algorithm;
+    info.block_bytes  = static_cast<std::uint32_t>(message::max_byte_block_size(modulo));
+    info.number_bytes = static_cast<std::uint32_t>(message::byte_width(modulo));
+    if (info.block_bytes == 0)
+    {
+        std::cerr << "Modulo is too small to hold a byte." << std::endl;
+        return false;
+    }
+
+    if (file::same_file(input_path, output_path))
+    {
+        std::cerr << "Input and output are the same file: " << input_path << std::endl;
+        return false;
+    }
+
+    auto in = file::MappedFile::open_read(input_path);
+    if (!in.is_open())
+    {
+        return false;
+    }
+    info.length = in.size();
+
+    auto out = file::MappedFile::create(output_path, info.encrypted_size());
+    if (!out.is_open())
+    {
+        return false;
+    }
+    Write_File_Encryption_Header(info, out.data());
+
+    const std::size_t record_bytes = info.numbers_per_block() * info.number_bytes;
+    exec::parallel_for(0, info.blocks(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        // One set of temporaries per chunk of blocks.
+        mpz_class block{};
+        typename std::decay<Function>::type::State worker_state{};
+        for (std::uint64_t i = first; i < last; ++i)
+        {
+            const std::uint64_t offset = i * info.block_bytes;
+            const std::size_t length = static_cast<std::size_t>(
+                std::min<std::uint64_t>(info.block_bytes, info.length - offset));
+
+            message::bytes_to_integer(block, in.data() + offset, length);
+            encrypt_block(worker_state,
+                          block,
+                          out.data() + File_Encryption_Header + i * record_bytes,
+                          info.number_bytes);
+        }
+    });
+
+    return out.sync();
+}
+
+template<typename Function>
+static inline bool
+Decrypt_File(const std::string& input_path,
+             const std::string& output_path,
+             const std::uint8_t algorithm,
+             const mpz_class&   modulo,
+             Function&&         decrypt_block)
+{
+    if (file::same_file(input_path, output_path))
+    {
+        std::cerr << "Input and output are the same file: " << input_path << std::endl;
+        return false;
+    }
+
+    auto in = file::MappedFile::open_read(input_path);
+    if (!in.is_open())
+    {
+        return false;
+    }
+
+    File_Encryption_Info info{};
+    if (!Read_File_Encryption_Header(in, algorithm, modulo, info))
+    {
+        return false;
+    }
+
+    auto out = file::MappedFile::create(output_path, info.length);
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    const std::size_t record_bytes = info.numbers_per_block() * info.number_bytes;
+    exec::parallel_for(0, info.blocks(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        mpz_class block{};
+        for (std::uint64_t i = first; i < last; ++i)
+        {
+            const std::uint64_t offset = i * info.block_bytes;
+            const std::size_t length = static_cast<std::size_t>(
+                std::min<std::uint64_t>(info.block_bytes, info.length - offset));
+
+            decrypt_block(block,
+                          in.data() + File_Encryption_Header + i * record_bytes,
+                          info.number_bytes);
+
+            // A wrong key gives a number that doesn't fit, keep the low bytes so we never overflow.
+            if (mpz_sizeinbase(block.get_mpz_t(), 2) > 8 * length)
+            {
+                mpz_tdiv_r_2exp(block.get_mpz_t(), block.get_mpz_t(), 8 * length);
+            }
+            message::integer_to_bytes(block, out.data() + offset, length);
+        }
+    });
+
+    return out.sync();
+}
+
+// Only the ciphertext is kept per chunk, so it isn't allocated for every block.
+struct RSA_File_Encryptor
+{
+    const mpz_class& e;
+    const mpz_class& n;
+
+    struct State
+    {
+        mpz_class ciphertext;
+    };
+
+    void operator()(State& state, const mpz_class& plain, std::uint8_t* record, std::size_t width) const
+    {
+        mpz_powm(state.ciphertext.get_mpz_t(), plain.get_mpz_t(), e.get_mpz_t(), n.get_mpz_t());
+        message::integer_to_bytes(state.ciphertext, record, width);
+    }
+};
+
+// Every block is encrypted with a fresh k by ElGamalEncryptor, which holds the fixed-base tables
+// for g and PK_B.
+struct ElGamal_File_Encryptor
+{
+    const ElGamalEncryptor& encryptor;
+
+    struct State
+    {
+        ElGamalEncryptor::Ciphertext ciphertext;
+    };
+
+    void operator()(State& state, const mpz_class& plain, std::uint8_t* record, std::size_t width) const
+    {
+        encryptor.encrypt(plain, state.ciphertext);
+
+        message::integer_to_bytes(state.ciphertext.first, record, width);
+        message::integer_to_bytes(state.ciphertext.second, record + width, width);
+    }
+};
+
+//! @description: Encrypt a whole file with RSA. Blocks are encrypted in parallel.
+//! @params: input_path:  file to encrypt, any content
+//!          output_path: encrypted file, created or overwritten
+//!          e, n:        public key of the receiver
+//! @return false if a file could not be read or written.
+static inline bool
+RSA_Encrypt_File(const std::string& input_path,
+                 const std::string& output_path,
+                 const mpz_class&   e,
+                 const mpz_class&   n)
+{
+    return Encrypt_File(input_path, output_path, File_Encryption_RSA, n, RSA_File_Encryptor{ e, n });
+}
+
+//! @description: Decrypt a file written by RSA_Encrypt_File. Blocks are decrypted in parallel.
+//! @params: d, n: private key and modulo of the receiver
+//! @return false if the file could not be read or was not encrypted with this modulo.
+static inline bool
+RSA_Decrypt_File(const std::string& input_path,
+                 const std::string& output_path,
+                 const mpz_class&   d,
+                 const mpz_class&   n)
+{
+    return Decrypt_File(input_path, output_path, File_Encryption_RSA, n,
+                        [&](mpz_class& plain, const std::uint8_t* record, const std::size_t width)
+    {
+        mpz_class ciphertext{};
+        message::bytes_to_integer(ciphertext, record, width);
+        mpz_powm(plain.get_mpz_t(), ciphertext.get_mpz_t(), d.get_mpz_t(), n.get_mpz_t());
+    });
+}
+
+//! @description: Encrypt a whole file with ElGamal. Blocks are encrypted in parallel.
+//! @params: PK_B:      public key of the receiver (g^b mod p)
+//!          modulo:    p
+//!          generator: g
+//! @return false if a file could not be read or written.
+static inline bool
+ElGamal_Encrypt_File(const std::string& input_path,
+                     const std::string& output_path,
+                     const mpz_class&   PK_B,
+                     const mpz_class&   modulo,
+                     const mpz_class&   generator)
+{
+    const ElGamalEncryptor encryptor(PK_B, modulo, generator);
+    return Encrypt_File(input_path, output_path, File_Encryption_ElGamal, modulo,
+                        ElGamal_File_Encryptor{ encryptor });
+}
+
+//! @description: Decrypt a file written by ElGamal_Encrypt_File. Blocks are decrypted in parallel.
+//! @params: b:      private key of the receiver
+//!          modulo: p used for encryption
+//! @return false if the file could not be read or was not encrypted with this modulo.
+static inline bool
+ElGamal_Decrypt_File(const std::string& input_path,
+                     const std::string& output_path,
+                     const mpz_class&   b,
+                     const mpz_class&   modulo)
+{
+    // Find q: p - 1 - b.
+    const mpz_class q(modulo - 1 - b);
+
+    return Decrypt_File(input_path, output_path, File_Encryption_ElGamal, modulo,
+                        [&](mpz_class& plain, const std::uint8_t* record, const std::size_t width)
+    {
+        mpz_class ciphertext{};
+        mpz_class hint{};
+        message::bytes_to_integer(ciphertext, record, width);
+        message::bytes_to_integer(hint, record + width, width);
+
+        // Decryption: Ciphertext * Hint^q mod p
+        mpz_powm(hint.get_mpz_t(), hint.get_mpz_t(), q.get_mpz_t(), modulo.get_mpz_t());
+        mpz_mul(plain.get_mpz_t(), ciphertext.get_mpz_t(), hint.get_mpz_t());
+        mpz_mod(plain.get_mpz_t(), plain.get_mpz_t(), modulo.get_mpz_t());
+    });
+}
+
+} // namespace algos
+} // namespace crypto
+#endif // FILE_ENCRYPTION_HPP
@@ -20,6 +20,7 @@ namespace algos
 //!          e:    small number coprime to phi(n)
 //! @return: {m, e}, (Public Keys)
 //!           d      (Private Key, so in the real world, this is kept secret)
+//!           All zero if e isn't coprime to phi(m).
 static inline std::pair<std::pair<mpz_class, mpz_class>, mpz_class>
 RSA_Key_Generation_DS(const mpz_class p,
                       const mpz_class q,
@@ -30,23 +31,21 @@ RSA_Key_Generation_DS(const mpz_class p,
     mpz_class m = P * Q;
     mpz_class phi_m = math::Euler_Totient_primes(P, Q);
 
-    // Make sure that the small e is coprime to phi_n
-    assert(math::is_coprime(phi_m, e));
-
     // Find d such that d * e mod phi_m = 1;
     // We can rewrite the function so that its: d mod phi_m = 1 * e^-1 (or the inverse of e)
+    // It only exists if the small e is coprime to phi_m.
     mpz_class d{};
-    mpz_invert(d.get_mpz_t(),
-               mpz_class(e).get_mpz_t(), // What we want the inverse of
-               phi_m.get_mpz_t());       // Modulo
+    if (!math::Inverse_Modulo(d,
+                              e,      // What we want the inverse of
+                              phi_m)) // Modulo
+    {
+        std::cerr << "e is not coprime to phi(m), there is no private key." << std::endl;
+        return {};
+    }
 
     // Test.
     mpz_class check{};
-    mpz_class base = e * d;
-    mpz_powm_ui(check.get_mpz_t(),  // Result buffer
-                base.get_mpz_t(),   // Base (d * e)
-                1,                  // Exponent
-                phi_m.get_mpz_t()); // Modulo)
+    math::ModularRing(phi_m).mul(check, e, d);
 
     assert(check == 1);
 
@@ -58,6 +57,7 @@ RSA_Key_Generation_DS(const mpz_class p,
 //!          e:    small number coprime to phi(n)
 //! @return: {e, n}, (Public Keys)
 //!           d      (Private Key, so in the real world, this is kept secret)
+//!           All zero if e isn't coprime to phi(n).
 static inline std::pair<std::pair<mpz_class, mpz_class>, mpz_class>
 RSA_Key_Generation(const mpz_class p,
                    const mpz_class q,
@@ -68,26 +68,24 @@ RSA_Key_Generation(const mpz_class p,
     mpz_class n = P * Q;
     mpz_class phi_n = math::Euler_Totient_primes(P, Q);
 
-    // Make sure that the small e is coprime to phi_n
-    assert(math::is_coprime(phi_n, e));
-
     std::cout << "phi_n (in function) = " << phi_n << std::endl; 
     // Find d such that d * e mod phi_n = 1;
     // We can rewrite the function so that its: d mod phi_n = 1 * e^-1 (or the inverse of e)
+    // It only exists if the small e is coprime to phi_n.
     mpz_class d{};
-    mpz_invert(d.get_mpz_t(),
-               mpz_class(e).get_mpz_t(), // What we want the inverse of
-               phi_n.get_mpz_t());       // Modulo
+    if (!math::Inverse_Modulo(d,
+                              e,      // What we want the inverse of
+                              phi_n)) // Modulo
+    {
+        std::cerr << "e is not coprime to phi(n), there is no private key." << std::endl;
+        return {};
+    }
 
     std::cout << "d, also known as the private key (in function) = " << d << std::endl; 
 
     // Test.
     mpz_class check{};
-    mpz_class base = e * d;
-    mpz_powm_ui(check.get_mpz_t(),  // Result buffer
-                base.get_mpz_t(),   // Base (d * e)
-                1,                  // Exponent
-                phi_n.get_mpz_t()); // Modulo)
+    math::ModularRing(phi_n).mul(check, e, d);
 
     assert(check == 1);
 
@@ -107,11 +105,9 @@ RSA_Encrypt(const mpz_class& message,
     // VERY IMPORTANT
     assert(n > message);
 
+    // Base is the message, exponent is the small prime e, coprime to phi(n).
     mpz_class ciphertext{};
-    mpz_powm_ui(ciphertext.get_mpz_t(),
-                message.get_mpz_t(), // Base is the message
-                e.get_ui(),                     // Exponent is small prime e, coprime to phi(n)
-                n.get_mpz_t());                 // Modulo is n
+    math::ModularRing(n).pow(ciphertext, message, e);
 
     std::cout << "ciphertext = " << ciphertext << std::endl;
 
@@ -127,16 +123,43 @@ RSA_Decrypt(const mpz_class& ciphertext,
             const mpz_class& d,
             const mpz_class& n)
 {
+    // Exponent is the private key.
     mpz_class message{};
-    mpz_powm_ui(message.get_mpz_t(),
-                ciphertext.get_mpz_t(), // Base is the message
-                d.get_ui(),             // Exponent is the private key
-                n.get_mpz_t());         // Modulo is n
+    math::ModularRing(n).pow(message, ciphertext, d);
     
     // std::cout << "message = " << message << std::endl;
     return message;
 }
 
+//! @description: Decrypt using the RSA protocol and the Chinese Remainder Theorem.
+//!               Two half size exponentiations instead of one full size one.
+//! @params: p, q: primes of n = P * Q
+//!          dP:   d mod (p - 1)
+//!          dQ:   d mod (q - 1)
+//!          qInv: q^-1 mod p
+//! @return  message:    return the numerical representation of the plaintext
+static inline mpz_class
+RSA_Decrypt_CRT(const mpz_class& ciphertext,
+                const mpz_class& p,
+                const mpz_class& q,
+                const mpz_class& dP,
+                const mpz_class& dQ,
+                const mpz_class& qInv)
+{
+    const math::ModularRing ring_p(p);
+    const math::ModularRing ring_q(q);
+
+    mpz_class m_p{};
+    mpz_class m_q{};
+    ring_p.pow(m_p, ciphertext, dP);
+    ring_q.pow(m_q, ciphertext, dQ);
+
+    // message = m_q + q * (qInv * (m_p - m_q) mod p)
+    const math::ModInt h((math::ModInt(ring_p, m_p) - math::ModInt(ring_p, m_q)) * math::ModInt(ring_p, qInv));
+
+    return m_q + q * h.value();
+}
+
 //! @description: Sign and Encrypt using RSA Digital Signatures
 //! @params: private_key: private key of the sender
 //!          sender_semiprime: m, from m = p * q (provided to us)
@@ -154,18 +177,15 @@ RSA_Sign_and_Encrypt(const mpz_class& private_key,
     // VERY IMPORTANT
     assert(sender_semiprime > message);
     // std::cout << "sender_semiprime = " << sender_semiprime << "\tmessage = " << message << std::endl;
+    // Base is the message, exponent is the private key, modulo is m, from m = p * q.
     mpz_class signature{};
-    mpz_powm_ui(signature.get_mpz_t(),
-                message.get_mpz_t(),           // Base is the message
-                private_key.get_ui(),          // Exponent is the private key
-                sender_semiprime.get_mpz_t()); // Modulo is m, from m = p * q
+    math::ModularRing(sender_semiprime).pow(signature, message, private_key);
 
     std::cout << "x = " << signature << "\t";
+    // Base is the signature, exponent is the second part (h) of the public key of the Receiver,
+    // modulo is n, from n = r * s.
     mpz_class encryption{};
-    mpz_powm_ui(encryption.get_mpz_t(),
-                signature.get_mpz_t(),           // Base is the signature from the previous calculation
-                PK_receiver.second.get_ui(),     // Exponent is the second part (h) of the public key of the Receiver
-                receiver_semiprime.get_mpz_t()); // Modulo is n, from n = r * s
+    math::ModularRing(receiver_semiprime).pow(encryption, signature, PK_receiver.second);
 
     std::cout << "y = " << encryption << std::endl;
     return encryption;
@@ -186,19 +206,17 @@ RSA_Decrypt_and_Verify(const mpz_class& private_key,
                        const mpz_class& signed_message)
 
 {
+    // Base is the encryption from the Sender, exponent is the private key of the receiver,
+    // modulo is n, from n = r * s.
     mpz_class decryption{};
-    mpz_powm_ui(decryption.get_mpz_t(),
-                signed_message.get_mpz_t(),      // Base is the encryption from the Sender
-                private_key.get_ui(),            // Exponent is the private key of the receiver
-                receiver_semiprime.get_mpz_t()); // Modulo is n, from n = r * s
+    math::ModularRing(receiver_semiprime).pow(decryption, signed_message, private_key);
 
     std::cout << "z = " << decryption << "\t";
 
+    // Base is the signature, exponent is the second part of the public key of the Sender,
+    // modulo is m, from m = p * q.
     mpz_class verification{};
-    mpz_powm_ui(verification.get_mpz_t(),
-                decryption.get_mpz_t(),        // Base is the signature from the previous calculation
-                PK_sender.second.get_ui(),     // Exponent is the second part of the public key of the Sender
-                sender_semiprime.get_mpz_t()); // Modulo is m, from m = p * q
+    math::ModularRing(sender_semiprime).pow(verification, decryption, PK_sender.second);
     
     std::cout << "u = " << verification << std::endl;
 
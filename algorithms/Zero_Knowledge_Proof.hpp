@@ -3,39 +3,94 @@
 
 // Standard C/C++
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
 #include <stdlib.h>
+#include <string>
 #include <vector>
 
 // Internal
+#include "../utils/Exec_utils.hpp"
+#include "../utils/Hash_utils.hpp"
 #include "../utils/Math_utils.hpp"
 #include "../utils/Crypto_utils.hpp"
+#include "../utils/Random_utils.hpp"
+#include "../utils/Serial_utils.hpp"
 
 namespace crypto
 {
 namespace algos
 {
 
+// Public key P_i of every secret key s_i, so that s_i^2 * P_i = 1 mod N.
+// All of the inverses share one modular inversion (math::Batch_Inverse).
 static inline std::vector<mpz_class>
 Calculate_Public_Keys(const std::vector<mpz_class>& secret_keys,
                       const mpz_class&              modulo)
 {
     // The same number of secret keys generates the same number of public keys.
-    std::vector<mpz_class> pub_keys{};
-    pub_keys.reserve(secret_keys.size());
-    for (const auto& key : secret_keys)
+    const math::ModularRing ring(modulo);
+    std::vector<mpz_class> pub_keys(secret_keys.size());
+    for (std::size_t i = 0; i < secret_keys.size(); ++i)
     {
-        mpz_class pub_key{};
+        ring.square(pub_keys[i], secret_keys[i]);
+    }
+
+    // We need the inverse of the secret key squared to solve for P_i.
+    const bool invertible = math::Batch_Inverse(pub_keys, modulo);
+    assert(invertible);
+    if (!invertible)
+    {
+        return std::vector<mpz_class>{};
+    }
+
+    return pub_keys;
+}
+
+// Public keys for many provers sharing the same modulo, one vector of secret keys per prover.
+// Every key of every prover goes into a single batch, so the whole set costs one inversion.
+// Returns an empty vector if a secret key isn't invertible mod N.
+static inline std::vector<std::vector<mpz_class>>
+Calculate_Public_Keys(const std::vector<std::vector<mpz_class>>& provers_secret_keys,
+                      const mpz_class&                           modulo)
+{
+    std::vector<mpz_class> all_keys;
+    std::size_t total = 0;
+    for (const auto& secret_keys : provers_secret_keys)
+    {
+        total += secret_keys.size();
+    }
+    all_keys.reserve(total);
+
+    for (const auto& secret_keys : provers_secret_keys)
+    {
+        all_keys.insert(all_keys.end(), secret_keys.cbegin(), secret_keys.cend());
+    }
+
+    const math::ModularRing ring(modulo);
+    crypto::exec::parallel_for(0, all_keys.size(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        for (std::uint64_t i = first; i < last; ++i)
+        {
+            ring.square(all_keys[i], all_keys[i]);
+        }
+    });
 
-        // We need the inverse of the secret key to solve for x.
-        // s_i^2 * P_i = 1 mod N
-        mpz_class base(key * key);
-        mpz_class base_inv = math::Multiplicative_Inverse(base, modulo);
-        mpz_powm_ui(pub_key.get_mpz_t(), // Result buffer
-                    base_inv.get_mpz_t(), // Base (d * e)
-                    1,                   // Exponent
-                    modulo.get_mpz_t());      // Modulo)
+    if (!math::Batch_Inverse(all_keys, modulo))
+    {
+        return std::vector<std::vector<mpz_class>>{};
+    }
 
-        pub_keys.push_back(pub_key);
+    // Split back per prover.
+    std::vector<std::vector<mpz_class>> pub_keys;
+    pub_keys.reserve(provers_secret_keys.size());
+    auto next = std::make_move_iterator(all_keys.begin());
+    for (const auto& secret_keys : provers_secret_keys)
+    {
+        pub_keys.emplace_back(next, next + secret_keys.size());
+        next += secret_keys.size();
     }
 
     return pub_keys;
@@ -57,14 +112,12 @@ Zero_Knowledge_Proof(const mpz_class N,
 
     // Satisfy:
     // PrivKey[i]^2 * PubKey[i] mod N = 1
+    const math::ModularRing ring(N);
     for (size_t i = 0; i < PubKey.size(); ++i)
     {
         mpz_class result{};
-        mpz_class base = (PrivKey[i] * PrivKey[i]) * PubKey[i];
-        mpz_powm_ui(result.get_mpz_t(), // Result buffer
-                    base.get_mpz_t(), // Base (d * e)
-                    1,                   // Exponent
-                    N.get_mpz_t());      // Modulo)
+        ring.square(result, PrivKey[i]);
+        ring.mul(result, result, PubKey[i]);
 
         std::cout << "result = " << result << "\tPubKey = " << PubKey[i] << "\tPrivKey = " << PrivKey[i] << std::endl;
         assert(result == 1);
@@ -89,14 +142,12 @@ Zero_Knowledge_Proof(const mpz_class N,
     
     // Satisfy:
     // PrivKey[i]^2 * PubKey[i] mod N = 1
+    const math::ModularRing ring(N);
     for (size_t i = 0; i < PubKey.size(); ++i)
     {
         mpz_class result{};
-        mpz_class base = (PrivKey[i] * PrivKey[i]) * PubKey[i];
-        mpz_powm_ui(result.get_mpz_t(), // Result buffer
-                    base.get_mpz_t(), // Base (d * e)
-                    1,                   // Exponent
-                    N.get_mpz_t());      // Modulo)
+        ring.square(result, PrivKey[i]);
+        ring.mul(result, result, PubKey[i]);
 
         std::cout << "result = " << result << "\tPubKey = " << PubKey[i] << "\tPrivKey = " << PrivKey[i] << std::endl;
         assert(result == 1);
@@ -106,90 +157,464 @@ Zero_Knowledge_Proof(const mpz_class N,
 }
 
 
+// product = prod_j keys[j]^row[j] mod N for one challenge row.
+// Returns false if the row doesn't have one entry per key.
 static inline bool
-// Nobody else knows Alice's Private ID
-Zero_Knowledge_Proof(const mpz_class N,
-                     const std::vector<mpz_class> PubKey,
-                     const std::vector<mpz_class> PrivKey,
-                     const std::vector<mpz_class> random_numbers,
-                     const std::vector<std::vector<size_t>> mat)
+Challenge_Product(const math::ModularRing&      ring,
+                  const std::vector<mpz_class>& keys,
+                  const std::vector<size_t>&    row,
+                  mpz_class&                    product)
 {
-    // Random numbers from Alice needs to have the same number of columns
-    assert(random_numbers.size() == mat.size());
+    if (row.size() != keys.size())
+    {
+        return false;
+    }
 
-    // Private key size needs to have the same number of cols
-    assert(PrivKey.size() == mat[0].size());
+    product = 1;
+    mpz_class rop{};
+    for (size_t j = 0; j < keys.size(); ++j)
+    {
+        if (row[j] == 0)
+        {
+            continue;
+        }
 
-    // Calculate:
-    // random_numbers[i]^2 mod N = some answer
-    std::vector<mpz_class> numbers_to_Bob;
-    numbers_to_Bob.reserve(random_numbers.size());
+        if (row[j] == 1)
+        {
+            ring.mul(product, product, keys[j]);
+        }
+        else
+        {
+            ring.pow(rop, keys[j], static_cast<unsigned long>(row[j]));
+            ring.mul(product, product, rop);
+        }
+    }
+    return true;
+}
+
+static inline bool
+Challenge_Product(const mpz_class&              N,
+                  const std::vector<mpz_class>& keys,
+                  const std::vector<size_t>&    row,
+                  mpz_class&                    product)
+{
+    return Challenge_Product(math::ModularRing(N), keys, row, product);
+}
 
-    for (const auto& rand_num : random_numbers)
+// products[i] = prod_j keys[j]^mat[i][j] mod N, one product per challenge row.
+// Challenge entries are bits, so every row is a subset product of the keys. With enough rows a
+// math::SubsetProductTable is built once and each row costs a few multiplications.
+// Returns false if a row doesn't have one entry per key.
+static inline bool
+Challenge_Products(const math::ModularRing&                ring,
+                   const std::vector<mpz_class>&           keys,
+                   const std::vector<std::vector<size_t>>& mat,
+                   std::vector<mpz_class>&                 products)
+{
+    bool binary = true;
+    for (const auto& row : mat)
+    {
+        if (row.size() != keys.size())
+        {
+            return false;
+        }
+        binary = binary && std::all_of(row.cbegin(), row.cend(), [](const size_t bit) { return bit <= 1; });
+    }
+
+    products.resize(mat.size());
+
+    // A table costs 2^8 multiplications per 8 keys, a row about one per 2 keys.
+    const std::size_t table_cost = (keys.size() + 7) / 8 * 256;
+    if (binary && mat.size() * keys.size() / 2 > table_cost)
     {
-        mpz_class new_num{};
-        mpz_class base = rand_num * rand_num;
-        mpz_powm_ui(new_num.get_mpz_t(), // Result buffer
-                    base.get_mpz_t(),    // Base (d * e)
-                    1,                   // Exponent
-                    N.get_mpz_t());      // Modulo)
+        const math::SubsetProductTable table(keys, ring.modulo());
+        for (size_t i = 0; i < mat.size(); ++i)
+        {
+            table.product(products[i], mat[i]);
+        }
+        return true;
+    }
 
-        numbers_to_Bob.emplace_back(new_num);
+    for (size_t i = 0; i < mat.size(); ++i)
+    {
+        Challenge_Product(ring, keys, mat[i], products[i]);
+    }
+    return true;
+}
+
+static inline bool
+Challenge_Products(const mpz_class&                        N,
+                   const std::vector<mpz_class>&           keys,
+                   const std::vector<std::vector<size_t>>& mat,
+                   std::vector<mpz_class>&                 products)
+{
+    return Challenge_Products(math::ModularRing(N), keys, mat, products);
+}
+
+// Everything the verifier sees of one prover's identification.
+//   x_i = r_i^2 mod N                     (commitments)
+//   y_i = r_i * prod_j s_j^e_ij mod N     (responses to the challenge rows e_i)
+// and accepts if y_i^2 * prod_j P_j^e_ij = x_i mod N for every round.
+struct ZKP_Transcript
+{
+    mpz_class                        N;
+    std::vector<mpz_class>           PubKey;
+    std::vector<mpz_class>           commitments;
+    std::vector<std::vector<size_t>> challenges;
+    std::vector<mpz_class>           responses;
+};
+
+// Prover's side: commitments and responses for the given random numbers and challenge rows.
+// Returns a transcript without responses if the sizes don't match.
+static inline ZKP_Transcript
+ZKP_Prove(const mpz_class&                        N,
+          const std::vector<mpz_class>&           PubKey,
+          const std::vector<mpz_class>&           PrivKey,
+          const std::vector<mpz_class>&           random_numbers,
+          const std::vector<std::vector<size_t>>& mat)
+{
+    ZKP_Transcript transcript{ N, PubKey, {}, mat, {} };
+    const math::ModularRing ring(N);
+    std::vector<mpz_class> products;
+    if (random_numbers.size() != mat.size() || !Challenge_Products(ring, PrivKey, mat, products))
+    {
+        return transcript;
     }
-    // Alice's Proof of Identity to Bob
-    // Bob sends this matrix to Alice and Alice calculates new numbers
-    std::vector<mpz_class> numbers_to_Bob_challenge;
-    numbers_to_Bob_challenge.reserve(numbers_to_Bob.size());
+
+    transcript.commitments.resize(random_numbers.size());
+    transcript.responses.resize(random_numbers.size());
     for (size_t i = 0; i < random_numbers.size(); ++i)
     {
-        mpz_class result = random_numbers[i];
-        for (size_t j = 0; j < mat[i].size(); ++j)
+        ring.square(transcript.commitments[i], random_numbers[i]);
+        ring.mul(transcript.responses[i], random_numbers[i], products[i]);
+    }
+
+    return transcript;
+}
+
+// Verifier's side. No console output and no asserts: a bad or malformed transcript is just false.
+static inline bool
+ZKP_Verify(const ZKP_Transcript& transcript)
+{
+    const auto& N = transcript.N;
+    const auto rounds = transcript.challenges.size();
+    if (N <= 1 || rounds == 0 ||
+        transcript.commitments.size() != rounds ||
+        transcript.responses.size() != rounds)
+    {
+        return false;
+    }
+
+    const math::ModularRing ring(N);
+    std::vector<mpz_class> products;
+    if (!Challenge_Products(ring, transcript.PubKey, transcript.challenges, products))
+    {
+        return false;
+    }
+
+    mpz_class R{};
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        // x = 0 would accept y = 0 without knowing anything.
+        if (transcript.commitments[i] <= 0 || transcript.commitments[i] >= N)
+        {
+            return false;
+        }
+
+        ring.square(R, transcript.responses[i]);
+        ring.mul(R, R, products[i]);
+
+        if (R != transcript.commitments[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Verify many independent provers at once, spread over the exec pool.
+// accepted[k] tells whether transcripts[k] verified; one bad proof doesn't affect the others.
+static inline std::vector<bool>
+ZKP_Verify_Batch(const std::vector<ZKP_Transcript>& transcripts,
+                 crypto::exec::ThreadPool&          pool = crypto::exec::default_pool())
+{
+    // std::vector<bool> packs bits, so the workers can't write to it directly.
+    std::vector<char> results(transcripts.size(), 0);
+    crypto::exec::parallel_for(0, transcripts.size(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        for (std::uint64_t k = first; k < last; ++k)
         {
-            mpz_class rop{};
-            mpz_ui_pow_ui(rop.get_mpz_t(), PrivKey[j].get_ui(), mat[i][j]);
-            // std::cout << "PrivKey Entry: " << PrivKey[j] << std::endl;
-            // std::cout << "Matrix Entry: " << mat[i][j] << std::endl;
-            // std::cout << "operation: " << result << " * " << rop << std::endl;
-            result *= rop;
+            results[k] = ZKP_Verify(transcripts[k]) ? 1 : 0;
         }
+    }, 1, pool);
 
-        mpz_class R{};
-        mpz_class base(result);
-        mpz_powm_ui(R.get_mpz_t(),  // Result buffer
-                    base.get_mpz_t(),   // Base (d * e)
-                    1,                  // Exponent
-                    N.get_mpz_t()); // Modulo)
+    return std::vector<bool>(results.cbegin(), results.cend());
+}
 
-        numbers_to_Bob_challenge.emplace_back(R);
-        // std::cout << "Number to Bob #" << i << ": " << R << std::endl;
-        // std::cout << std::endl;
+// Non-interactive (Fiat-Shamir) mode: instead of Bob sending the challenge matrix, the challenge
+// bits are derived from a hash of everything the prover committed to, so a proof is one blob
+// that can be checked offline. The blob is a serial::Type::ZKP_Proof record:
+//   N, key count, public keys, round count, commitments | responses
+// and the challenges are the bits of SHA-256(seed || counter), counter = 0, 1, ... (8 bytes,
+// big endian), where
+//   seed = SHA-256(context size (8 bytes, big endian) || context || record up to the commitments)
+// The context is chosen by the verifier (a session nonce, the service name, ...), so a proof
+// only counts for the session it was made for and can't be replayed in another one.
+// A cheating prover can only win by guessing all of the bits, so a proof carries at least
+// ZKP_Fiat_Shamir_Bits of them (rounds * keys).
+static constexpr std::size_t ZKP_Fiat_Shamir_Bits = 128;
+
+// What a verifier expects a non-interactive proof to be about: the identity (N and the public
+// keys) it already knows, and the context the proof has to be bound to.
+struct ZKP_Statement
+{
+    mpz_class              N;
+    std::vector<mpz_class> PubKey;
+    std::string            context;
+};
+
+static inline std::vector<std::vector<size_t>>
+ZKP_Fiat_Shamir_Challenges(const std::string&  context,
+                           const std::uint8_t* statement,
+                           const std::size_t   size,
+                           const std::size_t   rounds,
+                           const std::size_t   keys)
+{
+    std::uint8_t context_size[8];
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        context_size[i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(context.size()) >> (56 - 8 * i));
     }
 
-    // Bob's Verification
-    for (size_t i = 0; i < numbers_to_Bob_challenge.size(); ++i)
+    crypto::hash::SHA256 seed_hasher;
+    seed_hasher.update(context_size, sizeof(context_size));
+    seed_hasher.update(context);
+    seed_hasher.update(statement, size);
+    const auto seed = seed_hasher.finish();
+
+    std::vector<std::vector<size_t>> mat(rounds, std::vector<size_t>(keys));
+    crypto::hash::SHA256::Digest block{};
+    std::uint64_t counter = 0;
+    std::size_t bit = 8 * block.size();
+    for (auto& row : mat)
     {
-        mpz_class result = numbers_to_Bob_challenge[i] * numbers_to_Bob_challenge[i];
-        for (size_t j = 0; j < mat[i].size(); ++j)
+        for (auto& entry : row)
         {
-            mpz_class rop{};
-            mpz_ui_pow_ui(rop.get_mpz_t(), PubKey[j].get_ui(), mat[i][j]);
-            result *= rop;
+            if (bit == 8 * block.size())
+            {
+                std::uint8_t encoded[8];
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    encoded[i] = static_cast<std::uint8_t>(counter >> (56 - 8 * i));
+                }
+                ++counter;
+
+                crypto::hash::SHA256 hasher;
+                hasher.update(seed.data(), seed.size());
+                hasher.update(encoded, sizeof(encoded));
+                block = hasher.finish();
+                bit = 0;
+            }
+
+            entry = (block[bit / 8] >> (7 - bit % 8)) & 1;
+            ++bit;
         }
+    }
+    return mat;
+}
+
+// Prover's side of the non-interactive mode, bound to the verifier's context. The random numbers r
+// come from the OS entropy pool: anyone who can predict them can divide them out of the published
+// responses and recover the private keys. Returns an empty blob if the keys don't match or N is
+// too small.
+static inline std::vector<std::uint8_t>
+ZKP_Prove_NonInteractive(const mpz_class&              N,
+                         const std::vector<mpz_class>& PubKey,
+                         const std::vector<mpz_class>& PrivKey,
+                         const std::string&            context,
+                         const std::size_t             challenge_bits = ZKP_Fiat_Shamir_Bits)
+{
+    if (N <= 3 || PubKey.empty() || PubKey.size() != PrivKey.size())
+    {
+        return std::vector<std::uint8_t>{};
+    }
 
-        mpz_class R{};
-        mpz_class base(result);
-        mpz_powm_ui(R.get_mpz_t(),  // Result buffer
-                    base.get_mpz_t(),   // Base (d * e)
-                    1,                  // Exponent
-                    N.get_mpz_t()); // Modulo)
+    const std::size_t keys   = PrivKey.size();
+    const std::size_t rounds = std::max<std::size_t>(1, (challenge_bits + keys - 1) / keys);
 
-        if (R != numbers_to_Bob[i])
+    // r must be a unit mod N, otherwise r^2 gives away a factor of N.
+    std::vector<mpz_class> random_numbers(rounds);
+    for (auto& r : random_numbers)
+    {
+        do
+        {
+            r = crypto::random::below(N - 2) + 2;
+        } while (math::gcd(r, N) != 1);
+    }
+
+    std::vector<std::uint8_t> proof;
+    crypto::serial::Writer writer(proof);
+    writer.begin(crypto::serial::Type::ZKP_Proof);
+    writer.number(N);
+    writer.word(keys);
+    for (const auto& key : PubKey)
+    {
+        writer.number(key);
+    }
+    writer.word(rounds);
+
+    const math::ModularRing ring(N);
+    mpz_class commitment{};
+    for (const auto& r : random_numbers)
+    {
+        ring.square(commitment, r);
+        writer.number(commitment);
+    }
+
+    const auto mat = ZKP_Fiat_Shamir_Challenges(context, proof.data(), proof.size(), rounds, keys);
+    std::vector<mpz_class> products;
+    Challenge_Products(ring, PrivKey, mat, products);
+
+    mpz_class response{};
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        ring.mul(response, random_numbers[i], products[i]);
+        writer.number(response);
+    }
+
+    return proof;
+}
+
+// Parses a non-interactive proof into a transcript and recomputes its challenges for `context`.
+// Returns false on malformed input, including trailing bytes.
+static inline bool
+ZKP_Read_Proof(const std::uint8_t* data,
+               const std::size_t   size,
+               const std::string&  context,
+               ZKP_Transcript&     transcript)
+{
+    crypto::serial::Reader reader(data, size);
+    std::uint64_t keys = 0;
+    if (!reader.begin(crypto::serial::Type::ZKP_Proof) ||
+        !reader.number(transcript.N) ||
+        !reader.word(keys) ||
+        keys > size - reader.position()) // every number takes at least one byte
+    {
+        return false;
+    }
+
+    transcript.PubKey.resize(keys);
+    for (auto& key : transcript.PubKey)
+    {
+        if (!reader.number(key))
         {
-            std::cout << "result: " << result << " != " << numbers_to_Bob_challenge[i] << std::endl;
             return false;
         }
-        assert(R == numbers_to_Bob[i]);
     }
+
+    std::uint64_t rounds = 0;
+    if (!reader.word(rounds) || rounds > (size - reader.position()) / 2)
+    {
+        return false;
+    }
+
+    transcript.commitments.resize(rounds);
+    for (auto& commitment : transcript.commitments)
+    {
+        if (!reader.number(commitment))
+        {
+            return false;
+        }
+    }
+
+    transcript.challenges = ZKP_Fiat_Shamir_Challenges(context, data, reader.position(), rounds, keys);
+
+    transcript.responses.resize(rounds);
+    for (auto& response : transcript.responses)
+    {
+        if (!reader.number(response))
+        {
+            return false;
+        }
+    }
+
+    return reader.at_end();
+}
+
+// Verifier's side of the non-interactive mode. The proof has to be about exactly the expected
+// N and public keys (a valid proof for keys the prover made up proves nothing), and made for the
+// expected context. Proofs carrying fewer than challenge_bits challenge bits are rejected.
+static inline bool
+ZKP_Verify_NonInteractive(const ZKP_Statement& expected,
+                          const std::uint8_t*  data,
+                          const std::size_t    size,
+                          const std::size_t    challenge_bits = ZKP_Fiat_Shamir_Bits)
+{
+    ZKP_Transcript transcript{};
+    return ZKP_Read_Proof(data, size, expected.context, transcript) &&
+           transcript.N == expected.N &&
+           transcript.PubKey == expected.PubKey &&
+           transcript.challenges.size() * transcript.PubKey.size() >= challenge_bits &&
+           ZKP_Verify(transcript);
+}
+
+static inline bool
+ZKP_Verify_NonInteractive(const ZKP_Statement&             expected,
+                          const std::vector<std::uint8_t>& proof,
+                          const std::size_t                challenge_bits = ZKP_Fiat_Shamir_Bits)
+{
+    return ZKP_Verify_NonInteractive(expected, proof.data(), proof.size(), challenge_bits);
+}
+
+// Verify many non-interactive proofs over the exec pool, proofs[k] against expected[k].
+// One result per proof; all false if the sizes don't match.
+static inline std::vector<bool>
+ZKP_Verify_NonInteractive_Batch(const std::vector<ZKP_Statement>&             expected,
+                                const std::vector<std::vector<std::uint8_t>>& proofs,
+                                const std::size_t                             challenge_bits = ZKP_Fiat_Shamir_Bits,
+                                crypto::exec::ThreadPool&                     pool = crypto::exec::default_pool())
+{
+    std::vector<char> results(proofs.size(), 0);
+    if (expected.size() != proofs.size())
+    {
+        return std::vector<bool>(proofs.size(), false);
+    }
+
+    crypto::exec::parallel_for(0, proofs.size(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        for (std::uint64_t k = first; k < last; ++k)
+        {
+            results[k] = ZKP_Verify_NonInteractive(expected[k], proofs[k], challenge_bits) ? 1 : 0;
+        }
+    }, 1, pool);
+
+    return std::vector<bool>(results.cbegin(), results.cend());
+}
+
+static inline bool
+// Nobody else knows Alice's Private ID
+Zero_Knowledge_Proof(const mpz_class N,
+                     const std::vector<mpz_class> PubKey,
+                     const std::vector<mpz_class> PrivKey,
+                     const std::vector<mpz_class> random_numbers,
+                     const std::vector<std::vector<size_t>> mat)
+{
+    // Random numbers from Alice needs to have the same number of columns
+    assert(random_numbers.size() == mat.size());
+
+    // Private key size needs to have the same number of cols
+    assert(PrivKey.size() == mat[0].size());
+
+    // Alice commits to random_numbers[i]^2 mod N, Bob sends this matrix to Alice and
+    // Alice answers every row. Bob checks the answers against her public keys.
+    const ZKP_Transcript transcript = ZKP_Prove(N, PubKey, PrivKey, random_numbers, mat);
+    if (!ZKP_Verify(transcript))
+    {
+        std::cout << "Proof of identity rejected" << std::endl;
+        return false;
+    }
+
     return true;
     // assert(check_1 == 1);
 
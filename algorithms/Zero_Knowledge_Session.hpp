@@ -0,0 +1,335 @@
+#ifndef ZERO_KNOWLEDGE_SESSION_HPP
+#define ZERO_KNOWLEDGE_SESSION_HPP
+
+// Standard C/C++
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// GMP
+#include <gmpxx.h>
+
+// Internal
+#include "../utils/Exec_utils.hpp"
+#include "../utils/Math_utils.hpp"
+#include "../utils/Random_utils.hpp"
+#include "Zero_Knowledge_Proof.hpp"
+
+namespace crypto
+{
+namespace algos
+{
+//! @description: Runs many multi-round Feige-Fiat-Shamir identifications at once.
+//!               Every session is a prover and a verifier exchanging messages over an in-process
+//!               channel (one exec::BoundedQueue inbox each):
+//!                 prover   -> verifier: commitment x_i = r_i^2
+//!                 verifier -> prover:   challenge row e_i (random bits)
+//!                 prover   -> verifier: response y_i = r_i * prod_j s_j^e_ij
+//!               The prover keeps up to `window` rounds in flight: when it answers round i it
+//!               already sends the commitment for round i + window, so its next commitments are
+//!               computed while the verifier is still checking earlier responses.
+//!               Prover and verifier are actors on the exec pool. A party only gets a task while
+//!               its inbox has messages, and it handles them one at a time, so thousands of
+//!               sessions share a fixed number of threads.
+//!               The verifier stops at the first wrong response; the session is then rejected.
+//!               The prover's r and the verifier's challenges come from the OS entropy pool
+//!               (crypto::random): a prover who could predict the challenges would pass every round
+//!               by committing to x = y^2 * prod_j P_j^e_j.
+//!               A cheating prover still passes with probability 2^-(rounds * keys), so like the
+//!               non-interactive mode a session has to carry at least ZKP_Fiat_Shamir_Bits challenge
+//!               bits. Sessions below that, without keys, or with mismatched keys are rejected when
+//!               they are added and never run.
+class ZKP_Session_Engine
+{
+public:
+    explicit ZKP_Session_Engine(const std::size_t         rounds,
+                                const std::size_t         window = 4,
+                                crypto::exec::ThreadPool& pool   = crypto::exec::default_pool())
+        : rounds_(rounds),
+          window_(std::max<std::size_t>(1, std::min(window, rounds))),
+          pool_(pool)
+    {
+        assert(rounds_ > 0);
+    }
+
+    ZKP_Session_Engine(const ZKP_Session_Engine&) = delete;
+    ZKP_Session_Engine& operator=(const ZKP_Session_Engine&) = delete;
+
+    std::size_t rounds()   const { return rounds_; }
+    std::size_t window()   const { return window_; }
+    std::size_t sessions() const { return sessions_.size(); }
+
+    //! @description: Adds a session between a prover holding PrivKey and a verifier who knows PubKey.
+    //!               A session that can't be sound (see above) is kept as rejected.
+    //! @return index of the session in the result of run()
+    std::size_t
+    add(const mpz_class&              N,
+        const std::vector<mpz_class>& PubKey,
+        const std::vector<mpz_class>& PrivKey)
+    {
+        if (N <= 3 ||
+            PubKey.empty() ||
+            PubKey.size() != PrivKey.size() ||
+            rounds_ * PubKey.size() < ZKP_Fiat_Shamir_Bits)
+        {
+            sessions_.emplace_back(nullptr);
+        }
+        else
+        {
+            sessions_.emplace_back(new Session(N, PubKey, PrivKey, 2 * window_ + 2));
+        }
+        return sessions_.size() - 1;
+    }
+
+    //! @description: Runs every session to completion and removes them from the engine.
+    //! @return accepted[k] for the k-th added session
+    std::vector<bool>
+    run()
+    {
+        {
+            crypto::exec::TaskGroup group(pool_);
+            group_ = &group;
+            for (auto& session : sessions_)
+            {
+                if (session)
+                {
+                    post(*session, session->prover, Message{ Message::Kind::Start, 0, {}, {} });
+                }
+            }
+            group.wait();
+            group_ = nullptr;
+        }
+
+        std::vector<bool> accepted;
+        accepted.reserve(sessions_.size());
+        for (const auto& session : sessions_)
+        {
+            accepted.push_back(session && session->accepted);
+        }
+        sessions_.clear();
+        return accepted;
+    }
+
+private:
+    struct Message
+    {
+        enum class Kind : std::uint8_t
+        {
+            Start,      // to the prover: send the first commitments
+            Commitment, // value = x_i
+            Challenge,  // bits  = e_i
+            Response,   // value = y_i
+        };
+
+        Kind                kind;
+        std::size_t         round;
+        mpz_class           value;
+        std::vector<size_t> bits;
+    };
+
+    struct Party
+    {
+        explicit Party(const std::size_t capacity)
+            : inbox(capacity)
+        {
+        }
+
+        crypto::exec::BoundedQueue<Message> inbox;
+        std::atomic<std::size_t>            pending{ 0 }; // messages posted but not handled yet
+    };
+
+    struct Session
+    {
+        Session(const mpz_class&              N_,
+                const std::vector<mpz_class>& PubKey_,
+                const std::vector<mpz_class>& PrivKey_,
+                const std::size_t             capacity)
+            : N(N_),
+              ring(N_),
+              PubKey(PubKey_),
+              PrivKey(PrivKey_),
+              prover(capacity),
+              verifier(capacity)
+        {
+        }
+
+        const mpz_class              N;
+        const math::ModularRing      ring;
+        const std::vector<mpz_class> PubKey;
+        const std::vector<mpz_class> PrivKey;
+
+        Party prover;
+        Party verifier;
+
+        // Prover's state: random numbers of the rounds in flight.
+        std::deque<mpz_class> random_numbers;
+        std::size_t           committed = 0;
+
+        // Verifier's state: commitment and challenge of the rounds in flight.
+        std::deque<std::pair<mpz_class, std::vector<size_t>>> open_rounds;
+        std::size_t                                           verified = 0;
+        bool                                                  done     = false;
+        bool                                                  accepted = false;
+    };
+
+    // Hand a message to a party, and give the party a task if it didn't have one.
+    void
+    post(Session& session, Party& party, Message&& message)
+    {
+        // Inboxes hold every message a party can have outstanding (2 * window + 1), so this only
+        // waits if the reader hasn't finished releasing a cell yet.
+        while (!party.inbox.try_push(std::move(message)))
+        {
+            std::this_thread::yield();
+        }
+
+        if (party.pending.fetch_add(1, std::memory_order_acq_rel) == 0)
+        {
+            group_->run([this, &session, &party]() { drain(session, party); });
+        }
+    }
+
+    // Handle messages until the inbox is empty. Only one task per party runs this at a time.
+    void
+    drain(Session& session, Party& party)
+    {
+        Message message{ Message::Kind::Start, 0, {}, {} };
+        do
+        {
+            const bool popped = party.inbox.try_pop(message);
+            assert(popped);
+            (void)popped;
+
+            if (&party == &session.prover)
+            {
+                prover_receive(session, message);
+            }
+            else
+            {
+                verifier_receive(session, message);
+            }
+        } while (party.pending.fetch_sub(1, std::memory_order_acq_rel) != 1);
+    }
+
+    void
+    commit(Session& session)
+    {
+        mpz_class r{};
+        do
+        {
+            r = crypto::random::below(session.N - 2) + 2;
+        } while (math::gcd(r, session.N) != 1);
+
+        mpz_class x{};
+        session.ring.square(x, r);
+
+        session.random_numbers.emplace_back(std::move(r));
+        post(session, session.verifier, Message{ Message::Kind::Commitment, session.committed++, std::move(x), {} });
+    }
+
+    void
+    prover_receive(Session& session, Message& message)
+    {
+        if (message.kind == Message::Kind::Start)
+        {
+            while (session.committed < window_)
+            {
+                commit(session);
+            }
+            return;
+        }
+
+        // Challenges come back in order, one per round in flight.
+        assert(message.kind == Message::Kind::Challenge);
+        mpz_class y{};
+        if (session.random_numbers.empty() ||
+            !Challenge_Product(session.ring, session.PrivKey, message.bits, y))
+        {
+            return; // the verifier never gets an answer, so the session is rejected
+        }
+
+        session.ring.mul(y, y, session.random_numbers.front());
+        session.random_numbers.pop_front();
+        post(session, session.verifier, Message{ Message::Kind::Response, message.round, std::move(y), {} });
+
+        if (session.committed < rounds_)
+        {
+            commit(session);
+        }
+    }
+
+    void
+    verifier_receive(Session& session, Message& message)
+    {
+        if (session.done)
+        {
+            return;
+        }
+
+        if (message.kind == Message::Kind::Commitment)
+        {
+            // x = 0 would accept y = 0 without knowing anything.
+            if (message.value <= 0 || message.value >= session.N)
+            {
+                session.done = true;
+                return;
+            }
+
+            const mpz_class random_bits(crypto::random::bits(session.PubKey.size()));
+            std::vector<size_t> bits(session.PubKey.size());
+            for (size_t j = 0; j < bits.size(); ++j)
+            {
+                bits[j] = mpz_tstbit(random_bits.get_mpz_t(), j);
+            }
+
+            session.open_rounds.emplace_back(std::move(message.value), bits);
+            post(session, session.prover, Message{ Message::Kind::Challenge, message.round, {}, std::move(bits) });
+            return;
+        }
+
+        assert(message.kind == Message::Kind::Response);
+        if (session.open_rounds.empty() || message.round != session.verified)
+        {
+            session.done = true;
+            return;
+        }
+
+        // y^2 * prod_j P_j^e_ij = x_i mod N
+        const auto& round = session.open_rounds.front();
+        mpz_class product{};
+        Challenge_Product(session.ring, session.PubKey, round.second, product);
+
+        mpz_class R{};
+        session.ring.square(R, message.value);
+        session.ring.mul(R, R, product);
+
+        if (R != round.first)
+        {
+            session.done = true;
+            return;
+        }
+
+        session.open_rounds.pop_front();
+        if (++session.verified == rounds_)
+        {
+            session.done     = true;
+            session.accepted = true;
+        }
+    }
+
+    const std::size_t         rounds_;
+    const std::size_t         window_;
+    crypto::exec::ThreadPool& pool_;
+    crypto::exec::TaskGroup*  group_ = nullptr;
+
+    std::vector<std::unique_ptr<Session>> sessions_; // nullptr: rejected by add()
+};
+
+} // namespace algos
+} // namespace crypto
+#endif // ZERO_KNOWLEDGE_SESSION_HPP
@@ -0,0 +1,113 @@
+#include "../algorithms/Batch_GCD.hpp"
+
+// Standard C/C++
+#include <fstream>
+#include <iostream>
+#include <map>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace
+{
+// Moduli from 64 bit primes, with a few primes reused on purpose.
+struct Corpus
+{
+    std::vector<mpz_class>              moduli;
+    std::map<std::size_t, mpz_class>    expected; // index -> shared part
+};
+
+Corpus
+Make_Corpus(const std::size_t count)
+{
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    const auto next_prime = [&]()
+    {
+        mpz_class prime(random.get_z_bits(64));
+        mpz_setbit(prime.get_mpz_t(), 63);
+        mpz_nextprime(prime.get_mpz_t(), prime.get_mpz_t());
+        return prime;
+    };
+
+    Corpus corpus{};
+    std::vector<std::pair<mpz_class, mpz_class>> primes;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        primes.emplace_back(next_prime(), next_prime());
+    }
+
+    // 3 and 500 share p, 77 and 78 share both primes.
+    primes[500].first  = primes[3].first;
+    primes[78]         = std::make_pair(primes[77].second, primes[77].first);
+    // 10, 20 and 30 share q.
+    primes[20].second = primes[10].second;
+    primes[30].second = primes[10].second;
+
+    for (const auto& p : primes)
+    {
+        corpus.moduli.emplace_back(p.first * p.second);
+    }
+
+    corpus.expected[3]   = primes[3].first;
+    corpus.expected[500] = primes[3].first;
+    corpus.expected[77]  = corpus.moduli[77];
+    corpus.expected[78]  = corpus.moduli[78];
+    corpus.expected[10]  = primes[10].second;
+    corpus.expected[20]  = primes[10].second;
+    corpus.expected[30]  = primes[10].second;
+
+    return corpus;
+}
+
+void
+Check(const Corpus& corpus, const std::vector<std::pair<std::size_t, mpz_class>>& shared)
+{
+    ASSERT_EQ(shared.size(), corpus.expected.size());
+    for (const auto& found : shared)
+    {
+        const auto expected = corpus.expected.find(found.first);
+        ASSERT_NE(expected, corpus.expected.end()) << found.first;
+        EXPECT_EQ(found.second, expected->second) << found.first;
+    }
+}
+} // namespace
+
+TEST(test_Batch_GCD, Shared_factors)
+{
+    const auto corpus = Make_Corpus(1001);
+
+    std::vector<std::pair<std::size_t, mpz_class>> shared;
+    ASSERT_TRUE(crypto::algos::Batch_GCD(corpus.moduli, shared));
+    Check(corpus, shared);
+}
+
+TEST(test_Batch_GCD, Spill_to_disk)
+{
+    const auto corpus = Make_Corpus(1001);
+
+    std::vector<std::pair<std::size_t, mpz_class>> shared;
+    ASSERT_TRUE(crypto::algos::Batch_GCD(corpus.moduli, shared, testing::TempDir()));
+    Check(corpus, shared);
+
+    // Nothing is left behind.
+    EXPECT_FALSE(std::ifstream(testing::TempDir() + "/batch_gcd_level_1.bin").good());
+
+    // Directory that doesn't exist.
+    EXPECT_FALSE(crypto::algos::Batch_GCD(corpus.moduli, shared, testing::TempDir() + "/no/such/directory"));
+}
+
+TEST(test_Batch_GCD, Small)
+{
+    std::vector<std::pair<std::size_t, mpz_class>> shared;
+    ASSERT_TRUE(crypto::algos::Batch_GCD({ mpz_class(15) }, shared));
+    EXPECT_TRUE(shared.empty());
+
+    ASSERT_TRUE(crypto::algos::Batch_GCD({ mpz_class(15), mpz_class(77), mpz_class(21) }, shared));
+    ASSERT_EQ(shared.size(), 3);
+    EXPECT_EQ(shared[0], std::make_pair(std::size_t(0), mpz_class(3)));
+    EXPECT_EQ(shared[1], std::make_pair(std::size_t(1), mpz_class(7)));
+    EXPECT_EQ(shared[2], std::make_pair(std::size_t(2), mpz_class(21)));
+}
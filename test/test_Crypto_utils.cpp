@@ -15,4 +15,13 @@ TEST(tests_Crypto_utils, Get_Public_Keys)
                                                 2);
     EXPECT_EQ(PKeys.first.first,  96);
     EXPECT_EQ(PKeys.first.second, 9);
+}
+
+TEST(tests_Crypto_utils, Get_Public_Keys_Fixed_Base)
+{
+    const math::FixedBasePow generator(2, 227);
+    auto PKeys = crypto::utils::Get_Public_Keys(51, 92, generator);
+    EXPECT_EQ(PKeys.first.first,  96);
+    EXPECT_EQ(PKeys.first.second, 9);
+    EXPECT_EQ(PKeys.second, 2);
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 // Standard C/C++
 #include <iostream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 // Google
 #include <gtest/gtest.h>
@@ -74,6 +78,46 @@ TEST(test_ElGamal, ElGamal_Signing)
     EXPECT_EQ(signing.second.second, 3); // Y
 }
 
+TEST(test_ElGamal, ElGamal_Fixed_Base)
+{
+    const math::FixedBasePow generator(2, 11);
+
+    auto key = crypto::algos::ElGamal_Key_Generation(8, generator);
+    EXPECT_EQ(key.first, 3);          // key
+    EXPECT_EQ(key.second.first, 2);   // generator
+    EXPECT_EQ(key.second.second, 11); // modulo
+
+    auto signing = crypto::algos::ElGamal_Sign(9, 8, 5, generator);
+    EXPECT_EQ(signing.first.first, 5);   // message
+    EXPECT_EQ(signing.first.second, 3);  // Public key of sender
+    EXPECT_EQ(signing.second.first, 6);  // X
+    EXPECT_EQ(signing.second.second, 3); // Y
+}
+
+TEST(test_ElGamal, ElGamal_Signing_Wide_Exponents)
+{
+    // p = 2^127 - 1. Keys and message are all wider than 64 bits.
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 127);
+    modulo -= 1;
+    const mpz_class generator(3);
+    const mpz_class R("618970019642690137449562111"); // 2^89 - 1, a prime that doesn't divide p - 1
+    const mpz_class r("12345678901234567890123456789");
+    const mpz_class message("55555555555555555555555555555");
+    ASSERT_TRUE(math::is_coprime(R, mpz_class(modulo - 1)));
+
+    const auto signing = crypto::algos::ElGamal_Sign(R, r, message, modulo, generator);
+    const auto fixed   = crypto::algos::ElGamal_Sign(R, r, message, math::FixedBasePow(generator, modulo));
+    EXPECT_EQ(signing, fixed);
+
+    mpz_class K{};
+    mpz_powm(K.get_mpz_t(), generator.get_mpz_t(), r.get_mpz_t(), modulo.get_mpz_t());
+    EXPECT_EQ(signing.first.second, K);
+
+    EXPECT_TRUE(crypto::algos::ElGamal_Verify(K, signing.second.first, signing.second.second, message, modulo, generator));
+    EXPECT_FALSE(crypto::algos::ElGamal_Verify(K, signing.second.first, signing.second.second, message + 1, modulo, generator));
+}
+
 TEST(test_ElGamal, ElGamal_Verification)
 {
     //
@@ -86,6 +130,49 @@ TEST(test_ElGamal, ElGamal_Verification)
     EXPECT_TRUE(verification);
 }
 
+TEST(test_ElGamal, ElGamal_Stream)
+{
+    // p = 2^127 - 1
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 127);
+    modulo -= 1;
+    const mpz_class generator(3);
+    const mpz_class b("98765432109876543210987654321");
+
+    mpz_class PK_B{};
+    mpz_powm(PK_B.get_mpz_t(), generator.get_mpz_t(), b.get_mpz_t(), modulo.get_mpz_t());
+
+    std::string text;
+    for (std::size_t i = 0; i < 10000; ++i)
+    {
+        text += "do not send files as attachments to emails ";
+    }
+
+    std::istringstream plaintext(text);
+    std::stringstream ciphertext;
+    const auto blocks = crypto::algos::ElGamal_Encrypt_Stream(plaintext,
+                                                              ciphertext,
+                                                              PK_B,
+                                                              modulo,
+                                                              generator);
+    const auto block_size = message::max_block_size(modulo);
+    EXPECT_EQ(block_size, 26);
+    EXPECT_EQ(blocks, (text.size() + block_size - 1) / block_size);
+
+    std::ostringstream decrypted;
+    EXPECT_EQ(crypto::algos::ElGamal_Decrypt_Stream(ciphertext, decrypted, b, modulo), blocks);
+    EXPECT_EQ(decrypted.str(), text);
+
+    // Characters outside of the alphabet are skipped. Capitals fold to lower case.
+    std::istringstream plaintext2("Hello, World!");
+    std::stringstream ciphertext2;
+    crypto::algos::ElGamal_Encrypt_Stream(plaintext2, ciphertext2, PK_B, modulo, generator);
+
+    std::ostringstream decrypted2;
+    crypto::algos::ElGamal_Decrypt_Stream(ciphertext2, decrypted2, b, modulo);
+    EXPECT_EQ(decrypted2.str(), "hello world");
+}
+
 // TEST(test_ElGamal, Exam_Cryptosystem)
 // {
 //     /************KEY GENERATION************
@@ -234,4 +321,198 @@ TEST(test_ElGamal, ElGamal_Verification)
 //                                                       generator);            // generator
 //     // Returns true if the calculation for A == g^Message
 //     EXPECT_TRUE(verification);
-// }
\ No newline at end of file
+// }
+
+TEST(test_ElGamal, ElGamal_Ephemeral_Pool)
+{
+    // p = 2^127 - 1
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 127);
+    modulo -= 1;
+
+    const mpz_class generator(3);
+    const mpz_class b("1234567890123456789");
+    mpz_class PK_B{};
+    mpz_powm(PK_B.get_mpz_t(), generator.get_mpz_t(), b.get_mpz_t(), modulo.get_mpz_t());
+    const mpz_class q(modulo - 1 - b);
+
+    const auto decrypt = [&](const std::pair<mpz_class, mpz_class>& encrypted)
+    {
+        mpz_class R{};
+        mpz_powm(R.get_mpz_t(), encrypted.second.get_mpz_t(), q.get_mpz_t(), modulo.get_mpz_t());
+        return mpz_class((encrypted.first * R) % modulo);
+    };
+
+    crypto::algos::ElGamalEphemeralPool pool(PK_B, math::FixedBasePow(generator, modulo), 16);
+    pool.fill();
+    EXPECT_EQ(pool.size(), pool.capacity());
+
+    // More encryptions than the pool holds, from several threads at once.
+    std::vector<std::thread> threads;
+    std::vector<std::vector<std::pair<mpz_class, mpz_class>>> results(4);
+    for (std::size_t t = 0; t < results.size(); ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (unsigned long i = 1; i <= 50; ++i)
+            {
+                results[t].push_back(crypto::algos::ElGamal_Encrypt(mpz_class(i * 1000 + t), pool));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::set<mpz_class> hints;
+    for (std::size_t t = 0; t < results.size(); ++t)
+    {
+        for (unsigned long i = 1; i <= 50; ++i)
+        {
+            const auto& encrypted = results[t][i - 1];
+            EXPECT_EQ(decrypt(encrypted), i * 1000 + t);
+            hints.insert(encrypted.second);
+        }
+    }
+
+    // Every pair was used once.
+    EXPECT_EQ(hints.size(), 4 * 50);
+}
+
+TEST(test_ElGamal, ElGamal_Encryptor)
+{
+    // Same numbers as ElGamal_Cryptosystem: p = 89, g = 3, b = 23, k = 57.
+    mpz_class PK_B{};
+    mpz_powm_ui(PK_B.get_mpz_t(), mpz_class(3).get_mpz_t(), 23, mpz_class(89).get_mpz_t());
+
+    const crypto::algos::ElGamalEncryptor encryptor(PK_B, 89, 3);
+    const crypto::algos::ElGamalDecryptor decryptor(23, 89);
+
+    crypto::algos::ElGamalEncryptor::Ciphertext encryption{};
+    ASSERT_TRUE(encryptor.encrypt(72, 57, encryption));
+    EXPECT_EQ(encryption.first,  56); // Ciphertext
+    EXPECT_EQ(encryption.second, 23); // Hint
+    EXPECT_EQ(decryptor.decrypt(encryption), 72);
+
+    // k out of range
+    EXPECT_FALSE(encryptor.encrypt(72, 0, encryption));
+    EXPECT_FALSE(encryptor.encrypt(72, 88, encryption));
+
+    // p = 23 can encrypt numbers, but not a single character of text.
+    const crypto::algos::ElGamalEncryptor small(mpz_class(3), 23, 5);
+    EXPECT_EQ(small.block_size(), 0);
+    EXPECT_TRUE(small.encrypt_text("hello").empty());
+    ASSERT_TRUE(small.encrypt(7, 3, encryption));
+}
+
+TEST(test_ElGamal, ElGamal_Encryptor_Threads)
+{
+    // p = 2^127 - 1
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 127);
+    modulo -= 1;
+
+    const mpz_class b("1234567890123456789");
+    const auto public_key = crypto::algos::ElGamal_Key_Generation(b, math::FixedBasePow(3, modulo));
+
+    const crypto::algos::ElGamalEncryptor encryptor(public_key);
+    const crypto::algos::ElGamalDecryptor decryptor(b, modulo);
+    EXPECT_EQ(encryptor.public_key(), public_key.first);
+
+    const std::string text = "the quick brown fox jumps over the lazy dog";
+
+    std::vector<std::thread> threads;
+    std::vector<std::string> decrypted(4);
+    for (std::size_t t = 0; t < decrypted.size(); ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                const auto ciphertexts = encryptor.encrypt_text(text);
+                EXPECT_EQ(ciphertexts.size(), (text.size() + encryptor.block_size() - 1) / encryptor.block_size());
+                decrypted[t] = decryptor.decrypt_text(ciphertexts);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& result : decrypted)
+    {
+        EXPECT_EQ(result, text);
+    }
+}
+
+TEST(test_ElGamal, ElGamal_Decrypt_Batch)
+{
+    // p = 2^521 - 1, with a private key wider than 64 bits.
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 521);
+    modulo -= 1;
+    const mpz_class b("987654321098765432109876543210987654321");
+
+    const auto public_key = crypto::algos::ElGamal_Key_Generation(b, math::FixedBasePow(3, modulo));
+    const crypto::algos::ElGamalEncryptor encryptor(public_key);
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    std::vector<mpz_class> messages(2000);
+    std::vector<crypto::algos::ElGamalEncryptor::Ciphertext> ciphertexts;
+    for (auto& message : messages)
+    {
+        message = random.get_z_range(modulo - 1) + 1;
+        ciphertexts.push_back(encryptor.encrypt(message));
+    }
+
+    std::vector<mpz_class> plains;
+    ASSERT_TRUE(crypto::algos::ElGamal_Decrypt_Batch(ciphertexts, b, modulo, plains));
+    EXPECT_EQ(plains, messages);
+
+    // A hint of 0 can't come from a real encryption. It only fails its own ciphertext.
+    ciphertexts[7].second = 0;
+    EXPECT_FALSE(crypto::algos::ElGamal_Decrypt_Batch(ciphertexts, b, modulo, plains));
+    EXPECT_EQ(plains[7], 0);
+    EXPECT_EQ(plains[6], messages[6]);
+    EXPECT_EQ(plains[8], messages[8]);
+
+    const crypto::algos::ElGamalDecryptor decryptor(b, modulo);
+    std::vector<bool> decrypted;
+    EXPECT_EQ(decryptor.decrypt_batch(ciphertexts, plains, decrypted), messages.size() - 1);
+    for (std::size_t i = 0; i < messages.size(); ++i)
+    {
+        EXPECT_EQ(decrypted[i], i != 7);
+        if (i != 7)
+        {
+            EXPECT_EQ(plains[i], messages[i]);
+        }
+    }
+}
+
+TEST(test_ElGamal, ElGamal_Decrypt_Batch_Composite)
+{
+    // Over a composite modulus a hint can be non-zero and still have no inverse.
+    const mpz_class modulo(89 * 97);
+    const crypto::algos::ElGamalDecryptor decryptor(5, modulo);
+    const std::vector<crypto::algos::ElGamalDecryptor::Ciphertext> ciphertexts =
+    {
+        { 1234, 2 }, { 4321, 89 * 3 }, { 42, 10 }, { 7, 97 }
+    };
+
+    std::vector<mpz_class> plains;
+    std::vector<bool> decrypted;
+    EXPECT_EQ(decryptor.decrypt_batch(ciphertexts, plains, decrypted), 2);
+    EXPECT_EQ(decrypted, std::vector<bool>({ true, false, true, false }));
+    for (std::size_t i = 0; i < ciphertexts.size(); i += 2)
+    {
+        mpz_class mask{};
+        mpz_powm_ui(mask.get_mpz_t(), ciphertexts[i].second.get_mpz_t(), 5, modulo.get_mpz_t());
+        EXPECT_EQ((plains[i] * mask) % modulo, ciphertexts[i].first);
+    }
+    EXPECT_EQ(plains[1], 0);
+    EXPECT_EQ(plains[3], 0);
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "../utils/Exec_utils.hpp"
+
+// Standard C/C++
+#include <atomic>
+#include <iostream>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(test_Exec_utils, parallel_for)
+{
+    std::vector<std::uint64_t> values(100000);
+    crypto::exec::parallel_for(0, values.size(), [&](const std::uint64_t first, const std::uint64_t last)
+    {
+        for (std::uint64_t i = first; i < last; ++i)
+        {
+            values[i] = i * i;
+        }
+    });
+
+    for (std::uint64_t i = 0; i < values.size(); ++i)
+    {
+        ASSERT_EQ(values[i], i * i);
+    }
+
+    // Empty and tiny ranges.
+    std::atomic<std::size_t> calls{ 0 };
+    crypto::exec::parallel_for(5, 5, [&](std::uint64_t, std::uint64_t) { ++calls; });
+    EXPECT_EQ(calls, 0);
+    crypto::exec::parallel_for(0, 1, [&](std::uint64_t, std::uint64_t) { ++calls; });
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(test_Exec_utils, TaskGroup)
+{
+    crypto::exec::ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+
+    std::atomic<std::uint64_t> sum{ 0 };
+    std::set<std::thread::id> threads;
+    std::mutex threads_mutex;
+    {
+        crypto::exec::TaskGroup group(pool);
+        for (std::uint64_t i = 1; i <= 1000; ++i)
+        {
+            group.run([&, i]()
+            {
+                sum += i;
+                std::lock_guard<std::mutex> lock(threads_mutex);
+                threads.insert(std::this_thread::get_id());
+            });
+        }
+        group.wait();
+        EXPECT_EQ(sum, 500500);
+    }
+    EXPECT_GE(threads.size(), 1);
+}
+
+TEST(test_Exec_utils, Exceptions)
+{
+    crypto::exec::ThreadPool pool(2);
+
+    // A throwing task still finishes the group, and wait() rethrows the first exception.
+    std::atomic<std::size_t> ran{ 0 };
+    crypto::exec::TaskGroup group(pool);
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+        group.run([&, i]()
+        {
+            ++ran;
+            if (i % 10 == 3)
+            {
+                throw std::runtime_error("task failed");
+            }
+        });
+    }
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    EXPECT_EQ(ran, 100);
+
+    // The exception is handed out once, and the group can be used again.
+    group.run([&]() { ++ran; });
+    EXPECT_NO_THROW(group.wait());
+    EXPECT_EQ(ran, 101);
+
+    EXPECT_THROW(crypto::exec::parallel_for(0, 64, [](std::uint64_t first, std::uint64_t)
+    {
+        if (first == 32)
+        {
+            throw std::runtime_error("chunk failed");
+        }
+    }, 4, pool), std::runtime_error);
+
+    // A plain task that throws doesn't take its worker down.
+    for (std::size_t i = 0; i < 2 * pool.size(); ++i)
+    {
+        pool.submit([]() { throw std::runtime_error("nobody is waiting"); });
+    }
+    std::atomic<std::size_t> after{ 0 };
+    crypto::exec::parallel_for(0, 64, [&](std::uint64_t first, std::uint64_t last) { after += last - first; }, 4, pool);
+    EXPECT_EQ(after, 64);
+}
+
+TEST(test_Exec_utils, Nested)
+{
+    // Groups waiting inside pool tasks must not run out of workers, even with one worker.
+    crypto::exec::ThreadPool pool(1);
+    std::atomic<std::uint64_t> count{ 0 };
+
+    crypto::exec::TaskGroup outer(pool);
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        outer.run([&]()
+        {
+            crypto::exec::parallel_for(0, 64, [&](const std::uint64_t first, const std::uint64_t last)
+            {
+                count += last - first;
+            }, 4, pool);
+        });
+    }
+    outer.wait();
+    EXPECT_EQ(count, 8 * 64);
+}
+
+TEST(test_Exec_utils, BoundedQueue)
+{
+    crypto::exec::BoundedQueue<std::uint64_t> queue(5);
+    EXPECT_EQ(queue.capacity(), 8);
+
+    std::uint64_t value = 0;
+    EXPECT_FALSE(queue.try_pop(value));
+    for (std::uint64_t i = 0; i < 8; ++i)
+    {
+        EXPECT_TRUE(queue.try_push(std::uint64_t(i)));
+    }
+    EXPECT_FALSE(queue.try_push(std::uint64_t(8)));
+    EXPECT_EQ(queue.size(), 8);
+
+    // FIFO
+    for (std::uint64_t i = 0; i < 8; ++i)
+    {
+        ASSERT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+
+    // Several producers and consumers, every value comes out exactly once.
+    constexpr std::uint64_t per_producer = 20000;
+    std::atomic<std::uint64_t> sum{ 0 };
+    std::atomic<std::uint64_t> popped{ 0 };
+    std::vector<std::thread> threads;
+    for (std::uint64_t p = 0; p < 3; ++p)
+    {
+        threads.emplace_back([&, p]()
+        {
+            for (std::uint64_t i = 0; i < per_producer; ++i)
+            {
+                std::uint64_t item = p * per_producer + i;
+                while (!queue.try_push(std::move(item)))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+        threads.emplace_back([&]()
+        {
+            std::uint64_t item = 0;
+            while (popped.load() < 3 * per_producer)
+            {
+                if (queue.try_pop(item))
+                {
+                    sum += item;
+                    ++popped;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const std::uint64_t n = 3 * per_producer;
+    EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
\ No newline at end of file
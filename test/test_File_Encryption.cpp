@@ -0,0 +1,128 @@
+#include "../algorithms/File_Encryption.hpp"
+
+// Standard C/C++
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+static std::vector<char>
+Read_Whole_File(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static std::vector<char>
+Write_Test_File(const std::string& path, const std::size_t size)
+{
+    // Any byte value, including leading zeros in a block.
+    std::vector<char> data(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        data[i] = static_cast<char>((i * 131 + i / 7) % 256);
+    }
+    for (std::size_t i = 0; i < size && i < 40; ++i)
+    {
+        data[i] = 0;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), data.size());
+    return data;
+}
+
+TEST(test_File_Encryption, RSA_File)
+{
+    const std::string dir = testing::TempDir();
+    const auto plaintext = Write_Test_File(dir + "rsa_plain.bin", 100003);
+
+    // p = 2^61 - 1, q = 2^89 - 1
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 61);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+    const mpz_class n(p * q);
+    const mpz_class e(65537);
+
+    mpz_class phi_n = math::Euler_Totient_primes(p, q);
+    mpz_class d{};
+    ASSERT_NE(mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi_n.get_mpz_t()), 0);
+
+    ASSERT_TRUE(crypto::algos::RSA_Encrypt_File(dir + "rsa_plain.bin", dir + "rsa_cipher.bin", e, n));
+    ASSERT_TRUE(crypto::algos::RSA_Decrypt_File(dir + "rsa_cipher.bin", dir + "rsa_decrypted.bin", d, n));
+    EXPECT_EQ(Read_Whole_File(dir + "rsa_decrypted.bin"), plaintext);
+
+    // Encrypted with a different modulo.
+    EXPECT_FALSE(crypto::algos::RSA_Decrypt_File(dir + "rsa_cipher.bin", dir + "rsa_bad.bin", d, p));
+    EXPECT_FALSE(crypto::algos::RSA_Decrypt_File(dir + "rsa_plain.bin", dir + "rsa_bad.bin", d, n));
+    EXPECT_FALSE(crypto::algos::RSA_Encrypt_File(dir + "does_not_exist.bin", dir + "rsa_bad.bin", e, n));
+
+    // Writing over the input is refused, also through a different spelling of the path, and the
+    // input is left alone.
+    EXPECT_FALSE(crypto::algos::RSA_Encrypt_File(dir + "rsa_plain.bin", dir + "rsa_plain.bin", e, n));
+    EXPECT_FALSE(crypto::algos::RSA_Encrypt_File(dir + "rsa_plain.bin", dir + "./rsa_plain.bin", e, n));
+    EXPECT_EQ(Read_Whole_File(dir + "rsa_plain.bin"), plaintext);
+    const auto ciphertext = Read_Whole_File(dir + "rsa_cipher.bin");
+    EXPECT_FALSE(crypto::algos::RSA_Decrypt_File(dir + "rsa_cipher.bin", dir + "rsa_cipher.bin", d, n));
+    EXPECT_EQ(Read_Whole_File(dir + "rsa_cipher.bin"), ciphertext);
+}
+
+TEST(test_File_Encryption, ElGamal_File)
+{
+    const std::string dir = testing::TempDir();
+    const auto plaintext = Write_Test_File(dir + "elgamal_plain.bin", 50021);
+
+    // p = 2^127 - 1
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 127);
+    modulo -= 1;
+    const mpz_class generator(3);
+    const mpz_class b("98765432109876543210987654321");
+
+    mpz_class PK_B{};
+    mpz_powm(PK_B.get_mpz_t(), generator.get_mpz_t(), b.get_mpz_t(), modulo.get_mpz_t());
+
+    ASSERT_TRUE(crypto::algos::ElGamal_Encrypt_File(dir + "elgamal_plain.bin",
+                                                    dir + "elgamal_cipher.bin",
+                                                    PK_B,
+                                                    modulo,
+                                                    generator));
+    ASSERT_TRUE(crypto::algos::ElGamal_Decrypt_File(dir + "elgamal_cipher.bin",
+                                                    dir + "elgamal_decrypted.bin",
+                                                    b,
+                                                    modulo));
+    EXPECT_EQ(Read_Whole_File(dir + "elgamal_decrypted.bin"), plaintext);
+
+    // Fresh keys every run: the same file never encrypts to the same bytes twice.
+    ASSERT_TRUE(crypto::algos::ElGamal_Encrypt_File(dir + "elgamal_plain.bin",
+                                                    dir + "elgamal_cipher_again.bin",
+                                                    PK_B,
+                                                    modulo,
+                                                    generator));
+    EXPECT_NE(Read_Whole_File(dir + "elgamal_cipher_again.bin"), Read_Whole_File(dir + "elgamal_cipher.bin"));
+
+    // RSA files are not ElGamal files.
+    EXPECT_FALSE(crypto::algos::ElGamal_Decrypt_File(dir + "rsa_cipher.bin",
+                                                     dir + "elgamal_bad.bin",
+                                                     b,
+                                                     modulo));
+}
+
+TEST(test_File_Encryption, Empty_File)
+{
+    const std::string dir = testing::TempDir();
+    Write_Test_File(dir + "empty.bin", 0);
+
+    const mpz_class n(851);
+    ASSERT_TRUE(crypto::algos::RSA_Encrypt_File(dir + "empty.bin", dir + "empty_cipher.bin", 53, n));
+    ASSERT_TRUE(crypto::algos::RSA_Decrypt_File(dir + "empty_cipher.bin", dir + "empty_decrypted.bin", 269, n));
+    EXPECT_TRUE(Read_Whole_File(dir + "empty_decrypted.bin").empty());
+}
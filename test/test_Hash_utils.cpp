@@ -0,0 +1,51 @@
+#include "../utils/Hash_utils.hpp"
+
+// Standard C/C++
+#include <string>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(test_Hash_utils, SHA256)
+{
+    using crypto::hash::sha256;
+    using crypto::hash::to_hex;
+
+    // FIPS 180-4 examples
+    EXPECT_EQ(to_hex(sha256("")),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(to_hex(sha256("abc")),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(to_hex(sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // Padding that fits in the last block, padding that needs another one, an exact block.
+    EXPECT_EQ(to_hex(sha256(std::string(55, 'a'))),
+              "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+    EXPECT_EQ(to_hex(sha256(std::string(56, 'a'))),
+              "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+    EXPECT_EQ(to_hex(sha256(std::string(64, 'a'))),
+              "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb");
+}
+
+TEST(test_Hash_utils, SHA256_Incremental)
+{
+    // One million 'a', fed in uneven pieces.
+    const std::string piece(997, 'a');
+    crypto::hash::SHA256 hasher;
+    std::size_t fed = 0;
+    for (std::size_t size = 1; fed < 1000000; size = size % 997 + 1)
+    {
+        const std::size_t take = std::min(size, 1000000 - fed);
+        hasher.update(reinterpret_cast<const std::uint8_t*>(piece.data()), take);
+        fed += take;
+    }
+    EXPECT_EQ(crypto::hash::to_hex(hasher.finish()),
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+    hasher.reset();
+    hasher.update(std::string("ab"));
+    hasher.update(std::string("c"));
+    EXPECT_EQ(hasher.finish(), crypto::hash::sha256("abc"));
+}
@@ -0,0 +1,132 @@
+#include "../utils/Keystore_utils.hpp"
+#include "../algorithms/RSA.hpp"
+
+// Standard C/C++
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(test_Keystore_utils, Round_trip)
+{
+    const std::string path = testing::TempDir() + "keystore.bin";
+
+    // p = 2^61 - 1, q = 2^89 - 1
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 61);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+
+    mpz_class prime{};
+    mpz_ui_pow_ui(prime.get_mpz_t(), 2, 127);
+    prime -= 1;
+
+    {
+        crypto::keystore::Builder builder{};
+        ASSERT_TRUE(builder.add_rsa_key("rsa", p, q, 65537));
+        // 3 divides phi(n), and q = p has no inverse mod p.
+        EXPECT_FALSE(builder.add_rsa_key("bad_e", 7, 11, 3));
+        EXPECT_FALSE(builder.add_rsa_key("bad_q", 7, 7, 5));
+        builder.add_group("group", prime, 3);
+        builder.add_curve("curve", 23, 2, 3, std::make_pair(mpz_class(0), mpz_class(3)), 28);
+        builder.add("misc", crypto::keystore::Kind::Numbers, { mpz_class(-5), mpz_class(0), mpz_class(7) });
+        builder.add_fixed_base("group_g", math::FixedBasePow(3, prime));
+        ASSERT_TRUE(builder.write(path));
+    }
+
+    const auto store = crypto::keystore::Keystore::open(path);
+    ASSERT_TRUE(store.is_open());
+    EXPECT_EQ(store.size(), 5);
+
+    // RSA key with its CRT values.
+    crypto::keystore::RSA_Key key{};
+    ASSERT_TRUE(store.rsa_key("rsa", key));
+    EXPECT_EQ(key.n, p * q);
+    EXPECT_EQ(key.e, 65537);
+    EXPECT_EQ((key.d * key.e) % ((p - 1) * (q - 1)), 1);
+    EXPECT_EQ(key.dP, key.d % (p - 1));
+    EXPECT_EQ(key.dQ, key.d % (q - 1));
+    EXPECT_EQ((key.qInv * q) % p, 1);
+
+    const mpz_class message("123456789012345678901234567890");
+    mpz_class ciphertext{};
+    mpz_powm(ciphertext.get_mpz_t(), message.get_mpz_t(), key.e.get_mpz_t(), key.n.get_mpz_t());
+    EXPECT_EQ(crypto::algos::RSA_Decrypt_CRT(ciphertext, key.p, key.q, key.dP, key.dQ, key.qInv), message);
+
+    // Group with Montgomery constants.
+    crypto::keystore::Group group{};
+    ASSERT_TRUE(store.group("group", group));
+    EXPECT_EQ(group.modulo, prime);
+    EXPECT_EQ(group.generator, 3);
+    mpz_class R{};
+    mpz_setbit(R.get_mpz_t(), 8 * sizeof(mp_limb_t) * mpz_size(prime.get_mpz_t()));
+    EXPECT_EQ(group.montgomery_R2, (R * R) % prime);
+    mpz_class word{};
+    mpz_setbit(word.get_mpz_t(), 8 * sizeof(mp_limb_t));
+    EXPECT_EQ((group.montgomery_inverse * prime + 1) % word, 0);
+
+    // The stored constants give the same Montgomery context as building one.
+    math::MontgomeryContext context{};
+    ASSERT_TRUE(store.montgomery("group", context));
+    const math::MontgomeryContext built(prime);
+    ASSERT_EQ(context.limbs(), built.limbs());
+    EXPECT_TRUE(std::equal(context.r_squared(), context.r_squared() + context.limbs(), built.r_squared()));
+    EXPECT_TRUE(std::equal(context.one(), context.one() + context.limbs(), built.one()));
+    const mpz_class power("98765432109876543210987654321");
+    mpz_class montgomery_result{};
+    mpz_class built_result{};
+    context.pow(montgomery_result, 3, power);
+    built.pow(built_result, 3, power);
+    EXPECT_EQ(montgomery_result, built_result);
+    EXPECT_FALSE(store.montgomery("curve", context));
+
+    // Constants that don't belong to the modulo are rejected.
+    EXPECT_FALSE(context.load(prime, group.montgomery_R2, group.montgomery_inverse + 2));
+    EXPECT_FALSE(context.load(prime, prime, group.montgomery_inverse));
+    EXPECT_FALSE(context.load(prime + 1, group.montgomery_R2, group.montgomery_inverse));
+
+    // Fixed-base table, usable without rebuilding.
+    math::FixedBasePow table{};
+    ASSERT_TRUE(store.fixed_base("group_g", table));
+    EXPECT_EQ(table.modulo(), prime);
+    EXPECT_EQ(table.table().size(), math::FixedBasePow(3, prime).table().size());
+    const mpz_class exponent("98765432109876543210987654321");
+    mpz_class expected{};
+    mpz_powm(expected.get_mpz_t(), mpz_class(3).get_mpz_t(), exponent.get_mpz_t(), prime.get_mpz_t());
+    EXPECT_EQ(table.pow(exponent), expected);
+    EXPECT_FALSE(store.fixed_base("group", table));
+
+    crypto::keystore::Curve curve{};
+    ASSERT_TRUE(store.curve("curve", curve));
+    EXPECT_EQ(curve.modulo, 23);
+    EXPECT_EQ(curve.generator.second, 3);
+    EXPECT_EQ(curve.order, 28);
+
+    // Views read straight from the mapping.
+    crypto::keystore::Keystore::Entry entry{};
+    ASSERT_TRUE(store.find("misc", entry));
+    EXPECT_EQ(entry.count(), 3);
+    EXPECT_EQ(mpz_cmp_si(entry.view(0).get(), -5), 0);
+    EXPECT_EQ(mpz_sgn(entry.view(1).get()), 0);
+    EXPECT_EQ(entry.get(2), 7);
+
+    // Wrong names and kinds.
+    EXPECT_FALSE(store.find("nothing", entry));
+    EXPECT_FALSE(store.rsa_key("group", key));
+}
+
+TEST(test_Keystore_utils, Invalid_file)
+{
+    const std::string path = testing::TempDir() + "not_a_keystore.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "definitely not a keystore, but long enough to have a header";
+    }
+    EXPECT_FALSE(crypto::keystore::Keystore::open(path).is_open());
+    EXPECT_FALSE(crypto::keystore::Keystore::open(testing::TempDir() + "missing_keystore.bin").is_open());
+}
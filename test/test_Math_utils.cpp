@@ -21,6 +21,60 @@ TEST(test_Math_utils, is_generator)
     EXPECT_TRUE(math::is_generator(747073, 5));
 }
 
+TEST(test_Math_utils, gcd)
+{
+    EXPECT_EQ(math::gcd(12, 18), 6);
+    EXPECT_EQ(math::gcd(0, 7), 7);
+    EXPECT_EQ(math::gcd(7, 0), 7);
+    EXPECT_EQ(math::gcd(-12, 18), 6);
+    EXPECT_EQ(math::gcd(std::uint64_t(1) << 63, std::uint64_t(3) << 40), std::uint64_t(1) << 40);
+    EXPECT_EQ(math::gcd<std::uint64_t>(18446744073709551557ull, 18446744073709551533ull), 1); // primes
+    EXPECT_TRUE(math::is_coprime(35, 64));
+    EXPECT_FALSE(math::is_coprime(35, 65));
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+    for (int i = 0; i < 200; ++i)
+    {
+        const mpz_class common(random.get_z_bits(1 + i % 300));
+        const mpz_class a(common * random.get_z_bits(64 + i * 7));
+        const mpz_class b(common * random.get_z_bits(1 + i * 11));
+
+        mpz_class expected{};
+        mpz_gcd(expected.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        ASSERT_EQ(math::gcd(a, b), expected) << a << " " << b;
+        ASSERT_EQ(math::gcd(b, a), expected);
+    }
+    EXPECT_EQ(math::gcd(mpz_class(-12), mpz_class(18)), 6);
+    EXPECT_EQ(math::gcd(mpz_class(0), mpz_class(0)), 0);
+}
+
+TEST(test_Math_utils, Inverse_Modulo)
+{
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+    for (int i = 0; i < 200; ++i)
+    {
+        const mpz_class modulo(random.get_z_bits(2 + i * 13) + 2);
+        const mpz_class x(random.get_z_bits(1 + i * 17) - random.get_z_bits(i * 5)); // any sign and size
+
+        mpz_class expected{};
+        mpz_class inverse{};
+        const bool exists = mpz_invert(expected.get_mpz_t(), x.get_mpz_t(), modulo.get_mpz_t()) != 0;
+        ASSERT_EQ(math::Inverse_Modulo(inverse, x, modulo), exists);
+        if (exists)
+        {
+            ASSERT_EQ(inverse, expected);
+        }
+
+        mpz_class g{};
+        mpz_class cofactor{};
+        math::Extended_GCD(g, cofactor, x, modulo);
+        ASSERT_EQ(g, math::gcd(mpz_class(x % modulo), modulo));
+        ASSERT_EQ(mpz_class(cofactor * x - g) % modulo, 0);
+    }
+}
+
 TEST(test_Math_utils, Multiplicative_Inverse)
 {
     auto inverse = math::Multiplicative_Inverse(1001, 1024);
@@ -36,6 +90,420 @@ TEST(test_Math_utils, Multiplicative_Inverse)
     EXPECT_EQ(inverse4, 905);
 }
 
+TEST(test_Math_utils, Reducer)
+{
+    const auto power_of_two = [](const unsigned long k)
+    {
+        mpz_class power{};
+        mpz_ui_pow_ui(power.get_mpz_t(), 2, k);
+        return power;
+    };
+
+    const std::vector<std::pair<mpz_class, math::Reducer::Form>> moduli = {
+        { power_of_two(127) - 1, math::Reducer::Form::Generic }, // mpz_mod is faster at this size
+        { power_of_two(255) - 19, math::Reducer::Form::Pseudo_Mersenne },
+        { power_of_two(521) - 1, math::Reducer::Form::Pseudo_Mersenne },
+        { mpz_class("ffffffff00000001000000000000000000000000ffffffffffffffffffffffff", 16),
+          math::Reducer::Form::NIST_P256 },
+        { mpz_class("fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
+                    "ffffffff0000000000000000ffffffff", 16),
+          math::Reducer::Form::NIST_P384 },
+        { mpz_class("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f", 16),
+          math::Reducer::Form::Generic }, // secp256k1, c = 2^32 + 977 is too wide
+        { power_of_two(256) - 189 + power_of_two(200), math::Reducer::Form::Generic }, // odd, not special
+    };
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    for (const auto& modulus : moduli)
+    {
+        const mpz_class& p = modulus.first;
+        const math::Reducer reducer(p);
+        EXPECT_EQ(reducer.form(), modulus.second) << p;
+
+        std::vector<mpz_class> values = { 0, 1, p - 1, p, p + 1, 2 * p, (p - 1) * (p - 1), p * p,
+                                          power_of_two(2 * mpz_sizeinbase(p.get_mpz_t(), 2)) - 1,
+                                          -p, -(p - 1) * (p - 1) };
+        for (int i = 0; i < 500; ++i)
+        {
+            values.push_back(random.get_z_range(p) * random.get_z_range(p));
+            values.push_back(-values.back());
+            values.push_back(random.get_z_bits(i * 3)); // up to ~1500 bits, wider than p^2
+        }
+
+        for (const auto& value : values)
+        {
+            mpz_class expected{};
+            mpz_mod(expected.get_mpz_t(), value.get_mpz_t(), p.get_mpz_t());
+            mpz_class reduced(value);
+            reducer.reduce(reduced);
+            EXPECT_EQ(reduced, expected) << "p = " << p << ", x = " << value;
+        }
+
+        const mpz_class a = random.get_z_range(p);
+        const mpz_class b = random.get_z_range(p);
+        mpz_class product{};
+        reducer.mul(product, a, b);
+        EXPECT_EQ(product, (a * b) % p);
+    }
+}
+
+TEST(test_Math_utils, MontgomeryContext)
+{
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(49);
+
+    mpz_class p25519{};
+    mpz_ui_pow_ui(p25519.get_mpz_t(), 2, 255);
+    p25519 -= 19;
+    const mpz_class rsa("1522605027922533360535618378132637429718068114961380688657908494580122963258952897654000350692006139");
+    const mpz_class wide(random.get_z_bits(2048) * 2 + 1);
+
+    for (const auto& n : { mpz_class(3), mpz_class(227), p25519, rsa, wide })
+    {
+        const math::MontgomeryContext context(n);
+        std::vector<mp_limb_t> x(context.limbs());
+        std::vector<mp_limb_t> y(context.limbs());
+
+        for (int i = 0; i < 20; ++i)
+        {
+            const mpz_class a(random.get_z_range(n));
+            const mpz_class b(random.get_z_range(n));
+
+            // Round trip, with inputs that are not reduced.
+            mpz_class back{};
+            context.to_montgomery(x.data(), a + n * 5);
+            context.from_montgomery(back, x.data());
+            EXPECT_EQ(back, a);
+            context.to_montgomery(x.data(), a - n);
+            context.from_montgomery(back, x.data());
+            EXPECT_EQ(back, a);
+
+            // Products stay in Montgomery form, and the result may be an operand.
+            context.to_montgomery(y.data(), b);
+            context.mul(x.data(), x.data(), y.data());
+            context.from_montgomery(back, x.data());
+            EXPECT_EQ(back, a * b % n);
+
+            context.sqr(y.data(), y.data());
+            context.from_montgomery(back, y.data());
+            EXPECT_EQ(back, b * b % n);
+
+            // a R * b R^-1 = a b: a plain operand takes the factor out.
+            context.to_montgomery(x.data(), a);
+            context.mul(x.data(), x.data(), b);
+            context.import_limbs(back, x.data());
+            EXPECT_EQ(back, a * b % n);
+
+            const mpz_class e(random.get_z_bits(1 + i * 100));
+            mpz_class expected{};
+            mpz_powm(expected.get_mpz_t(), a.get_mpz_t(), e.get_mpz_t(), n.get_mpz_t());
+            mpz_class result{};
+            context.pow(result, a, e);
+            EXPECT_EQ(result, expected);
+        }
+
+        mpz_class result{};
+        context.pow(result, 5, 0);
+        EXPECT_EQ(result, 1);
+        context.pow(result, 0, 7);
+        EXPECT_EQ(result, 0);
+    }
+}
+
+TEST(test_Math_utils, ModularRing)
+{
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    mpz_class p25519{};
+    mpz_ui_pow_ui(p25519.get_mpz_t(), 2, 255);
+    p25519 -= 19;
+    const mpz_class rsa("1522605027922533360535618378132637429718068114961380688657908494580122963258952897654000350692006139");
+
+    for (const auto& n : { mpz_class(97), mpz_class(1024), p25519, rsa })
+    {
+        const math::ModularRing ring(n);
+        for (int i = 0; i < 200; ++i)
+        {
+            const mpz_class a = random.get_z_range(n);
+            const mpz_class b = random.get_z_range(n);
+            mpz_class result{};
+
+            ring.add(result, a, b);
+            EXPECT_EQ(result, (a + b) % n);
+            ring.sub(result, a, b);
+            EXPECT_EQ(result, ((a - b) % n + n) % n);
+            ring.neg(result, a);
+            EXPECT_EQ(result, (n - a) % n);
+            ring.mul(result, a, b);
+            EXPECT_EQ(result, (a * b) % n);
+            ring.square(result, a);
+            EXPECT_EQ(result, (a * a) % n);
+
+            // Small factors take the quotient estimate, large ones a full reduction.
+            for (const unsigned long factor : { 0ul, 1ul, 3ul, 8ul, 9ul, 1000003ul, ~0ul })
+            {
+                ring.mul_ui(result, a, factor);
+                EXPECT_EQ(result, (a * factor) % n);
+            }
+
+            if (ring.inverse(result, a))
+            {
+                EXPECT_EQ((result * a) % n, 1);
+            }
+            else
+            {
+                EXPECT_NE(math::gcd(a, n), 1);
+            }
+        }
+    }
+
+    // Elements, with operands that start out of range.
+    const math::ModularRing ring(rsa);
+    const math::ModInt x(ring, -rsa * 3 - 5);
+    const math::ModInt y(ring, rsa * rsa + 7);
+    EXPECT_EQ(x.value(), rsa - 5);
+    EXPECT_EQ(y.value(), 7);
+    EXPECT_EQ(math::ModInt(x + y).value(), 2);
+    EXPECT_EQ(math::ModInt(y - x).value(), 12);
+    EXPECT_EQ(math::ModInt(x * y).value(), rsa - 35);
+    EXPECT_EQ(math::ModInt(-x).value(), 5);
+    EXPECT_EQ(x.square().value(), 25);
+    EXPECT_EQ(y.pow(3).value(), 343);
+
+    math::ModInt inverse(ring, 0);
+    ASSERT_TRUE(y.inverse(inverse));
+    EXPECT_EQ(math::ModInt(inverse * y).value(), 1);
+    EXPECT_FALSE(math::ModInt(ring, 0).inverse(inverse));
+    EXPECT_EQ(inverse * y, math::ModInt(ring, 1));
+}
+
+TEST(test_Math_utils, ModExpr)
+{
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(48);
+
+    mpz_class p25519{};
+    mpz_ui_pow_ui(p25519.get_mpz_t(), 2, 255);
+    p25519 -= 19;
+    const mpz_class p256("ffffffff00000001000000000000000000000000ffffffffffffffffffffffff", 16);
+    const mpz_class rsa("1522605027922533360535618378132637429718068114961380688657908494580122963258952897654000350692006139");
+
+    for (const auto& n : { p25519, p256, rsa, mpz_class(101) })
+    {
+        const math::ModularRing ring(n);
+        const auto ref = [&](const mpz_class& v) { return math::ModRef(ring, v); };
+
+        for (int i = 0; i < 50; ++i)
+        {
+            const mpz_class a(random.get_z_range(n));
+            const mpz_class b(random.get_z_range(n));
+            const mpz_class c(random.get_z_range(n));
+
+            const auto expected = [&](mpz_class v)
+            {
+                v %= n;
+                return v < 0 ? mpz_class(v + n) : v;
+            };
+
+            mpz_class result{};
+            math::evaluate(result, ref(a) * ref(b) + ref(c));
+            EXPECT_EQ(result, expected(a * b + c));
+
+            math::evaluate(result, (ref(a) - ref(b) * ref(c)) * ref(c) - 8 * square(ref(a)));
+            EXPECT_EQ(result, expected((a - b * c) * c - 8 * a * a));
+
+            math::evaluate(result, square(ref(a) * ref(b) - ref(c)) * (3 * (ref(b) + ref(c))));
+            EXPECT_EQ(result, expected((a * b - c) * (a * b - c) * 3 * (b + c)));
+
+            math::evaluate(result, -(ref(a) * 2 + -ref(b)));
+            EXPECT_EQ(result, expected(-(2 * a - b)));
+
+            // The result may be one of the operands.
+            mpz_class x(a);
+            math::evaluate(x, ref(x) * ref(b) + ref(x));
+            EXPECT_EQ(x, expected(a * b + a));
+
+            math::ModInt y(ring, a);
+            const math::ModInt z(ring, b);
+            y = y * z + y;
+            EXPECT_EQ(y.value(), expected(a * b + a));
+            y *= z - y;
+            EXPECT_EQ(y.value(), expected((a * b + a) * (b - a * b - a)));
+            y -= square(z);
+            y += 2 * z;
+            EXPECT_EQ(y.value(), expected((a * b + a) * (b - a * b - a) - b * b + 2 * b));
+            EXPECT_EQ(math::ModInt(ref(a) * z).value(), expected(a * b));
+        }
+    }
+}
+
+TEST(test_Math_utils, Square_and_Multiply_Exponentiation)
+{
+    // The exponent reaching 1 used to skip the last multiplication.
+    EXPECT_EQ(math::Square_and_Multiply_Exponentiation(29, 16, 2), 24);
+    EXPECT_EQ(math::Square_and_Multiply_Exponentiation(29, 16, 1), 16);
+    EXPECT_EQ(math::Square_and_Multiply_Exponentiation(29, 16, 0), 1);
+    EXPECT_EQ(math::Square_and_Multiply_Exponentiation(29, -13, 3), (16 * 16 * 16) % 29);
+    EXPECT_EQ(math::Square_and_Multiply_Exponentiation(29, 16, -1), math::Multiplicative_Inverse(mpz_class(16), mpz_class(29)));
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(50);
+
+    // Odd moduli go through Montgomery products, even ones through the ring. Exponent lengths cover
+    // every window width.
+    const mpz_class odd(random.get_z_bits(1024) * 2 + 1);
+    const mpz_class even(random.get_z_bits(521) * 2);
+    for (const auto& modulo : { odd, even, mpz_class(2), mpz_class(1u << 31) })
+    {
+        for (const std::size_t bits : { 1, 2, 7, 24, 64, 100, 256, 600, 1024, 3000 })
+        {
+            const mpz_class base(random.get_z_bits(1100));
+            const mpz_class exponent(random.get_z_bits(bits) + 1);
+
+            mpz_class expected{};
+            mpz_powm(expected.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+            EXPECT_EQ(math::Square_and_Multiply_Exponentiation(modulo, base, exponent), expected)
+                << "modulo = " << modulo << ", bits = " << bits;
+        }
+    }
+}
+
+TEST(test_Math_utils, FixedBasePow)
+{
+    // p = 2^127 - 1
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 127);
+    modulo -= 1;
+    const mpz_class base(3);
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    for (std::size_t window : { 1, 3, 4, 5, 8 })
+    {
+        const math::FixedBasePow table(base, modulo, 0, window);
+        std::vector<mpz_class> exponents = { 0, 1, 2, modulo - 2, modulo - 1,
+                                             modulo * modulo, // wider than the table
+                                             -1 };            // negative
+        for (int i = 0; i < 20; ++i)
+        {
+            exponents.push_back(random.get_z_range(modulo));
+        }
+
+        for (const auto& exponent : exponents)
+        {
+            mpz_class expected{};
+            mpz_powm(expected.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+            EXPECT_EQ(table.pow(exponent), expected) << "window = " << window << ", e = " << exponent;
+        }
+    }
+
+    // Tables can be handed back in.
+    const math::FixedBasePow table(2, 227);
+    EXPECT_EQ(table.pow(51ul), 96);
+
+    auto entries = table.table();
+    math::FixedBasePow loaded{};
+    EXPECT_FALSE(loaded.load(2, 227, table.exponent_bits() + 8, table.window(), std::vector<mpz_class>(entries)));
+    ASSERT_TRUE(loaded.load(2, 227, table.exponent_bits(), table.window(), std::move(entries)));
+    EXPECT_EQ(loaded.pow(92ul), 9);
+}
+
+TEST(test_Math_utils, Batch_Inverse)
+{
+    std::vector<mpz_class> values = { 1001, 2025, 1 };
+    ASSERT_TRUE(math::Batch_Inverse(values, 1024));
+    EXPECT_EQ(values[0], 89);
+    EXPECT_EQ((values[1] * 2025) % 1024, 1);
+    EXPECT_EQ(values[2], 1);
+
+    // Large enough to be split over the pool.
+    mpz_class modulo{};
+    mpz_ui_pow_ui(modulo.get_mpz_t(), 2, 127);
+    modulo -= 1;
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+    std::vector<mpz_class> original(20000);
+    for (auto& value : original)
+    {
+        value = random.get_z_range(modulo - 1) + 1;
+    }
+    original[5] += modulo; // not reduced
+
+    values = original;
+    ASSERT_TRUE(math::Batch_Inverse(values, modulo));
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        ASSERT_EQ((values[i] * original[i]) % modulo, 1) << i;
+    }
+
+    // Nothing changes if one value has no inverse.
+    values = original;
+    values[12345] = modulo * 3;
+    const auto before = values;
+    EXPECT_FALSE(math::Batch_Inverse(values, modulo));
+    EXPECT_EQ(values, before);
+}
+
+TEST(test_Math_utils, SubsetProductTable)
+{
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+    const mpz_class half(random.get_z_bits(511) + 3);
+
+    // Odd moduli use Montgomery products, even ones the ring.
+    for (const mpz_class& modulo : { mpz_class(2 * half + 1), mpz_class(2 * half) })
+    {
+        // 21 values: two full chunks of 8 and a short one of 5.
+        std::vector<mpz_class> values(21);
+        for (auto& value : values)
+        {
+            value = random.get_z_range(modulo);
+        }
+
+        for (const std::size_t chunk_bits : { std::size_t(1), std::size_t(3), std::size_t(8) })
+        {
+            const math::SubsetProductTable table(values, modulo, chunk_bits);
+            EXPECT_EQ(table.size(), values.size());
+
+            for (int round = 0; round < 50; ++round)
+            {
+                std::vector<std::size_t> bits(values.size());
+                mpz_class expected(1);
+                for (std::size_t j = 0; j < bits.size(); ++j)
+                {
+                    bits[j] = mpz_class(random.get_z_bits(1)).get_ui();
+                    if (bits[j] != 0)
+                    {
+                        expected = (expected * values[j]) % modulo;
+                    }
+                }
+
+                mpz_class product{};
+                table.product(product, bits);
+                ASSERT_EQ(product, expected);
+            }
+
+            // No bits set, and all of them.
+            mpz_class product{};
+            table.product(product, std::vector<std::size_t>(values.size(), 0));
+            EXPECT_EQ(product, 1);
+
+            mpz_class all(1);
+            for (const auto& value : values)
+            {
+                all = (all * value) % modulo;
+            }
+            table.product(product, std::vector<std::size_t>(values.size(), 1));
+            EXPECT_EQ(product, all);
+        }
+    }
+}
+
 TEST(test_Math_utils, Square_Roots_Modulo)
 {
     // std::vector<mpz_class> sq_roots = math::Square_Roots_Modulo(7,  // p (modulo)
@@ -53,6 +521,107 @@ TEST(test_Math_utils, Square_Roots_Modulo)
     }
 }
 
+TEST(test_Math_utils, Square_Root_Modulo)
+{
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    // 3 mod 4, 5 mod 8, and primes with a large power of 2 in p - 1 (Tonelli-Shanks).
+    mpz_class p25519{};
+    mpz_ui_pow_ui(p25519.get_mpz_t(), 2, 255);
+    p25519 -= 19;
+    mpz_class p224{};
+    mpz_ui_pow_ui(p224.get_mpz_t(), 2, 224);
+    p224 -= mpz_class("79228162514264337593543950336"); // 2^96
+    p224 += 1;
+
+    for (const mpz_class& p : { mpz_class(3571), mpz_class(13), mpz_class(17), mpz_class(257), mpz_class(65537), p25519, p224 })
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            const mpz_class x(random.get_z_range(p));
+            const mpz_class square((x * x) % p);
+
+            mpz_class root{};
+            ASSERT_TRUE(math::Square_Root_Modulo(root, square, p));
+            ASSERT_EQ((root * root) % p, square);
+            ASSERT_TRUE(root == x || root == p - x || (x == 0 && root == 0));
+        }
+
+        // A non-residue has no root.
+        mpz_class z(2);
+        while (mpz_legendre(z.get_mpz_t(), p.get_mpz_t()) != -1)
+        {
+            ++z;
+        }
+        mpz_class root{};
+        EXPECT_FALSE(math::Square_Root_Modulo(root, z, p));
+        EXPECT_EQ(math::Square_Roots_Modulo(p, z), std::vector<mpz_class>{ 0 });
+    }
+
+    // Both roots, for a p = 1 mod 4 too.
+    EXPECT_EQ(math::Square_Roots_Modulo(13, 10).size(), 2u);
+    for (const auto& root : math::Square_Roots_Modulo(13, 10))
+    {
+        EXPECT_EQ((root * root) % 13, 10);
+    }
+}
+
+TEST(test_Math_utils, Compress_point_ECC)
+{
+    // secp256k1: y^2 = x^3 + 7
+    const mpz_class p("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f", 16);
+    const mpz_class a(0);
+    const mpz_class b(7);
+    const std::pair<mpz_class, mpz_class> G(
+        mpz_class("79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798", 16),
+        mpz_class("483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8", 16));
+
+    std::pair<mpz_class, mpz_class> point{};
+    const auto compressed = math::Compress_point_ECC(G);
+    EXPECT_EQ(compressed.first, G.first);
+    EXPECT_FALSE(compressed.second);
+    ASSERT_TRUE(math::Decompress_point_ECC(point, compressed, p, a, b));
+    EXPECT_EQ(point, G);
+
+    // The other point with the same x.
+    ASSERT_TRUE(math::Decompress_point_ECC(point, std::make_pair(G.first, true), p, a, b));
+    EXPECT_EQ(point, std::make_pair(G.first, mpz_class(p - G.second)));
+
+    // Random points, and some x that aren't on the curve.
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+    std::vector<std::pair<mpz_class, mpz_class>> points;
+    std::vector<mpz_class> off_curve;
+    while (points.size() < 1000 || off_curve.empty())
+    {
+        const mpz_class x(random.get_z_range(p));
+        mpz_class y{};
+        if (math::Square_Root_Modulo(y, x * x * x + a * x + b, p))
+        {
+            points.emplace_back(x, random.get_z_bits(1) == 0 ? y : mpz_class(p - y));
+        }
+        else
+        {
+            off_curve.push_back(x);
+        }
+    }
+
+    std::vector<std::pair<mpz_class, bool>> compressed_points;
+    for (const auto& P : points)
+    {
+        compressed_points.push_back(math::Compress_point_ECC(P));
+    }
+
+    std::vector<std::pair<mpz_class, mpz_class>> decompressed;
+    ASSERT_TRUE(math::Decompress_points_ECC(decompressed, compressed_points, p, a, b));
+    EXPECT_EQ(decompressed, points);
+
+    compressed_points[500].first = off_curve[0];
+    EXPECT_FALSE(math::Decompress_points_ECC(decompressed, compressed_points, p, a, b));
+    EXPECT_FALSE(math::Decompress_point_ECC(point, std::make_pair(p, false), p, a, b));
+}
+
 TEST(test_Math_utils, Find_All_Points_ECC)
 {
     mpz_class modulo = 3571;
@@ -62,6 +631,21 @@ TEST(test_Math_utils, Find_All_Points_ECC)
     std::vector<std::pair<mpz_class, mpz_class>> 
     coordinates = math::Find_All_Points_ECC(modulo, a, b);
 
+    // Every point is on the curve, and they come back in order of x.
+    EXPECT_FALSE(coordinates.empty());
+    for (std::size_t i = 0; i < coordinates.size(); ++i)
+    {
+        const auto& x = coordinates[i].first;
+        const auto& y = coordinates[i].second;
+        mpz_class lhs = (y * y) % modulo;
+        mpz_class rhs = (x * x * x + a * x + b) % modulo;
+        EXPECT_EQ(lhs, rhs);
+        if (i > 0)
+        {
+            EXPECT_LE(coordinates[i - 1].first, x);
+        }
+    }
+
 
     // This returns 0 if no roots.
     // for (const auto& coords : coordinates)
@@ -100,3 +684,94 @@ TEST(test_Math_utils, Scalar_mult_points_to_ECC)
     auto new_points = math::Scalar_mult_points_to_ECC(P, k, modulo, a);
     std::cout << "x = " << new_points.first << "\t y = " << new_points.second << std::endl;
 }
+
+TEST(test_Math_utils, EllipticCurve)
+{
+    // secp256k1, generator of order n.
+    const mpz_class p("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f", 16);
+    const mpz_class n("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141", 16);
+    const math::EllipticCurve::Point G(
+        mpz_class("79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798", 16),
+        mpz_class("483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8", 16));
+    const math::EllipticCurve curve(p, 0, 7, G, n);
+
+    EXPECT_TRUE(curve.contains(G));
+    EXPECT_TRUE(math::EllipticCurve::is_infinity(curve.multiply(G, n)));
+    EXPECT_TRUE(math::EllipticCurve::is_infinity(curve.add(G, curve.negate(G))));
+    EXPECT_EQ(curve.add(G, math::EllipticCurve::infinity()), G);
+
+    // Only (-1, -1) is the point at infinity, other negative coordinates are not on the curve.
+    EXPECT_TRUE(curve.contains(math::EllipticCurve::infinity()));
+    EXPECT_FALSE(math::EllipticCurve::is_infinity(math::EllipticCurve::Point(-5, 3)));
+    EXPECT_FALSE(math::EllipticCurve::is_infinity(math::EllipticCurve::Point(-1, 3)));
+    EXPECT_FALSE(curve.contains(math::EllipticCurve::Point(-5, 3)));
+    EXPECT_FALSE(curve.contains(math::EllipticCurve::Point(-1, 3)));
+    EXPECT_FALSE(curve.contains(math::EllipticCurve::Point(G.first, -1)));
+
+    // 2G from the standard test vectors.
+    const math::EllipticCurve::Point G2(
+        mpz_class("c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5", 16),
+        mpz_class("1ae168fea63dc339a3c58419466ceaeef7f632653266d0e1236431a950cfe52a", 16));
+    EXPECT_EQ(curve.twice(G), G2);
+    EXPECT_EQ(curve.add(G, G), G2);
+
+    // The generator table, double-and-add and the group law agree.
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+    for (int i = 0; i < 20; ++i)
+    {
+        const mpz_class k(random.get_z_range(n));
+        const mpz_class l(random.get_z_range(n));
+        const auto kG = curve.multiply_generator(k);
+        ASSERT_TRUE(curve.contains(kG));
+        ASSERT_EQ(kG, curve.multiply(G, k));
+        ASSERT_EQ(curve.add(kG, curve.multiply_generator(l)), curve.multiply_generator(k + l));
+        ASSERT_EQ(curve.multiply(kG, l), curve.multiply(curve.multiply_generator(l), k));
+        ASSERT_EQ(curve.multiply_generator(-k), curve.negate(kG));
+    }
+
+    // Compressed points.
+    math::EllipticCurve::Point point{};
+    ASSERT_TRUE(curve.decompress(point, math::Compress_point_ECC(G2)));
+    EXPECT_EQ(point, G2);
+
+    // Small curve: y^2 = x^3 + 2x + 3 mod 97, built from a, p and a point on it.
+    const math::EllipticCurve small(97, 2, math::EllipticCurve::Point(3, 6));
+    EXPECT_EQ(small.b(), 3);
+    const auto points = math::Find_All_Points_ECC(97, 2, 3);
+    const mpz_class group_order(static_cast<unsigned long>(points.size() + 1)); // and infinity
+    for (const auto& P : points)
+    {
+        ASSERT_TRUE(small.contains(P));
+        for (const auto& Q : { points.front(), points.back(), P })
+        {
+            ASSERT_TRUE(small.contains(small.add(P, Q)));
+        }
+
+        // Every point's order divides |E(F_97)|.
+        ASSERT_TRUE(math::EllipticCurve::is_infinity(small.multiply(P, group_order)));
+    }
+
+    // The free functions agree with the curve.
+    EXPECT_EQ(math::Scalar_mult_points_to_ECC(G, 12345, p, 0), curve.multiply_generator(12345));
+    EXPECT_EQ(math::Add_points_to_ECC(G, G2, p, 0), curve.multiply_generator(3));
+
+    // P-256 runs on the NIST reduction kernel.
+    const mpz_class p256("ffffffff00000001000000000000000000000000ffffffffffffffffffffffff", 16);
+    const mpz_class n256("ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551", 16);
+    const math::EllipticCurve::Point G256(
+        mpz_class("6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296", 16),
+        mpz_class("4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5", 16));
+    const math::EllipticCurve curve256(p256, -3, G256, n256);
+    EXPECT_TRUE(curve256.contains(G256));
+    EXPECT_EQ(curve256.b(), mpz_class("5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b", 16));
+    EXPECT_EQ(curve256.multiply_generator(2), math::EllipticCurve::Point(
+        mpz_class("7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35a60b48fc47669978", 16),
+        mpz_class("07775510db8ed040293d9ac69f7430dbba7dade63ce982299e04b79d227873d1", 16)));
+    EXPECT_TRUE(math::EllipticCurve::is_infinity(curve256.multiply(G256, n256)));
+    for (int i = 0; i < 10; ++i)
+    {
+        const mpz_class k(random.get_z_range(n256));
+        ASSERT_EQ(curve256.multiply_generator(k), curve256.multiply(G256, k));
+    }
+}
@@ -4,6 +4,56 @@
 #include "../utils/Message_utils.hpp"
 
 
+TEST(test_Message_utils, char_to_numeric)
+{
+#ifndef using_ASCII
+    EXPECT_EQ(message::char_to_numeric('a'), 1);
+    EXPECT_EQ(message::char_to_numeric('z'), 26);
+    EXPECT_EQ(message::char_to_numeric('N'), 14); // Upper case folds to lower case.
+    EXPECT_EQ(message::char_to_numeric(' '), 27);
+    EXPECT_EQ(message::char_to_numeric('\0'), 0);
+    EXPECT_EQ(message::char_to_numeric('!'), std::numeric_limits<std::size_t>::max());
+
+    EXPECT_EQ(message::numeric_to_char(1), 'a');
+    EXPECT_EQ(message::numeric_to_char(26), 'z');
+    EXPECT_EQ(message::numeric_to_char(27), ' ');
+    EXPECT_EQ(message::numeric_to_char(mpz_class(14)), 'n');
+    EXPECT_EQ(message::numeric_to_char(28), '\0');
+    EXPECT_EQ(message::numeric_to_char(-1), '\0');
+#endif
+}
+
+TEST(test_Message_utils, text_to_numeric)
+{
+    // Long enough to go through the vectorized path and the scalar tail.
+    std::string str = "Do NOT send files as attachments to emails!\n@[`{";
+    str.push_back('\0');
+    str.push_back(static_cast<char>(0xC1));
+    str.push_back(static_cast<char>(0xFF));
+
+    const auto numeric = message::text_to_numeric(str);
+    ASSERT_EQ(numeric.size(), str.size());
+    for (std::size_t i = 0; i < str.size(); ++i)
+    {
+        const auto expected = message::char_to_numeric(str[i]);
+        if (expected == std::numeric_limits<std::size_t>::max())
+        {
+            EXPECT_EQ(numeric[i], message::unmapped_numeric) << "index " << i;
+        }
+        else
+        {
+            EXPECT_EQ(numeric[i], expected) << "index " << i;
+        }
+    }
+
+    std::string text(numeric.size(), ' ');
+    message::numeric_to_text(numeric.data(), numeric.size(), &text[0]);
+    for (std::size_t i = 0; i < str.size(); ++i)
+    {
+        EXPECT_EQ(text[i], message::numeric_to_char(numeric[i])) << "index " << i;
+    }
+}
+
 TEST(test_Message_utils, naive_plaintext_numeric)
 {
 #ifndef using_ASCII
@@ -157,6 +207,57 @@ TEST(test_Message_utils, long_message)
     EXPECT_EQ(str, decoded);
 }
 
+TEST(test_Message_utils, large_block_round_trip)
+{
+    // Large enough to go several levels into the divide and conquer conversion.
+    std::string str;
+    for (std::size_t i = 0; i < 20000; ++i)
+    {
+        str.push_back("the quick brown fox jumps over the lazy dog"[(i * 7) % 43]);
+    }
+
+    auto naive = message::naive_plaintext_numeric(str, str.size());
+    auto compressed = message::encode_naive_representation(naive);
+    ASSERT_EQ(compressed.size(), 1);
+
+    // Same value as evaluating the digits one at a time.
+    mpz_class expected{};
+    for (const auto& digit : naive[0])
+    {
+        expected = expected * SIZE_numeric_plaintext + digit;
+    }
+    EXPECT_EQ(compressed[0], expected);
+
+    EXPECT_EQ(message::decode_naive_representation(compressed), str);
+    EXPECT_EQ(message::decode_naive_representation(compressed[0]), str);
+
+    // Many blocks, with a padded last block.
+    auto blocks = message::naive_plaintext_numeric(str, 37);
+    auto compressed_blocks = message::encode_naive_representation(blocks);
+    EXPECT_EQ(message::decode_naive_representation(compressed_blocks), str);
+}
+
+TEST(test_Message_utils, integer_to_digits)
+{
+    message::RadixPowers powers(10);
+    powers.reserve(60);
+
+    mpz_class value("123456789012345678901234567890123456789012345678901234567890");
+    std::vector<std::uint8_t> digits(64);
+    message::integer_to_digits(value, digits.size(), digits.data(), powers);
+
+    std::string text;
+    for (const auto d : digits)
+    {
+        text.push_back(static_cast<char>('0' + d));
+    }
+    EXPECT_EQ(text, "0000" + value.get_str());
+
+    mpz_class back{};
+    message::digits_to_integer(back, digits.data(), digits.size(), powers);
+    EXPECT_EQ(back, value);
+}
+
 TEST(test_Message_utils, ASCII)
 {
 #ifdef using_ASCII
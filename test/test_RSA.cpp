@@ -30,6 +30,11 @@ TEST(test_RSA, RSA_Key_Generation)
     EXPECT_EQ(e2, 5);
     EXPECT_EQ(n2, 133);
     EXPECT_EQ(d2, 65);
+
+    // 3 divides phi_n = 60, so there is no private key.
+    const auto no_keys = crypto::algos::RSA_Key_Generation(7, 11, 3);
+    EXPECT_EQ(no_keys.second, 0);
+    EXPECT_EQ(crypto::algos::RSA_Key_Generation_DS(7, 11, 3).second, 0);
 }
 
 TEST(test_RSA, RSA_Cryptosystem)
@@ -0,0 +1,56 @@
+#include "../utils/Random_utils.hpp"
+
+// Standard C/C++
+#include <set>
+#include <vector>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(test_Random_utils, bits)
+{
+    for (const std::size_t count : { 1, 7, 8, 9, 64, 255, 1000 })
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            const mpz_class value(crypto::random::bits(count));
+            EXPECT_GE(value, 0);
+            EXPECT_LE(mpz_sizeinbase(value.get_mpz_t(), 2), count);
+        }
+    }
+    EXPECT_EQ(crypto::random::bits(0), 0);
+
+    // 256 random bits never repeat.
+    std::set<mpz_class> seen;
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(seen.insert(crypto::random::bits(256)).second);
+    }
+}
+
+TEST(test_Random_utils, below)
+{
+    // Every value of a small range shows up, and nothing outside it.
+    std::vector<int> counts(10, 0);
+    for (int i = 0; i < 2000; ++i)
+    {
+        const mpz_class value(crypto::random::below(10));
+        ASSERT_GE(value, 0);
+        ASSERT_LT(value, 10);
+        ++counts[value.get_ui()];
+    }
+    for (const int count : counts)
+    {
+        EXPECT_GT(count, 100);
+    }
+
+    const mpz_class n("1522605027922533360535618378132637429718068114961380688657908494580122963258952897654000350692006139");
+    for (int i = 0; i < 50; ++i)
+    {
+        const mpz_class value(crypto::random::below(n));
+        EXPECT_GE(value, 0);
+        EXPECT_LT(value, n);
+    }
+    EXPECT_EQ(crypto::random::below(1), 0);
+}
@@ -0,0 +1,154 @@
+#include "../utils/Serial_utils.hpp"
+#include "../utils/Math_utils.hpp"
+#include "../algorithms/ElGamal.hpp"
+#include "../algorithms/RSA.hpp"
+
+// Standard C/C++
+#include <iostream>
+#include <vector>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(test_Serial_utils, RSA)
+{
+    const auto keys = crypto::algos::RSA_Key_Generation(104801, 104803, 23);
+    const auto ciphertext = crypto::algos::RSA_Encrypt(315440, keys.first.first, keys.first.second);
+
+    // Several records in one buffer.
+    std::vector<std::uint8_t> buffer;
+    crypto::serial::write_rsa_public_key(buffer, keys.first);
+    crypto::serial::write_rsa_private_key(buffer, keys.second, keys.first.second);
+    crypto::serial::write_rsa_ciphertext(buffer, ciphertext);
+
+    crypto::serial::Reader reader(buffer);
+    std::pair<mpz_class, mpz_class> public_key{};
+    mpz_class d{};
+    mpz_class n{};
+    mpz_class c{};
+    ASSERT_TRUE(crypto::serial::read_rsa_public_key(reader, public_key));
+    ASSERT_TRUE(crypto::serial::read_rsa_private_key(reader, d, n));
+    ASSERT_TRUE(crypto::serial::read_rsa_ciphertext(reader, c));
+    EXPECT_TRUE(reader.at_end());
+
+    EXPECT_EQ(public_key, keys.first);
+    EXPECT_EQ(d, keys.second);
+    EXPECT_EQ(n, keys.first.second);
+    EXPECT_EQ(c, ciphertext);
+}
+
+TEST(test_Serial_utils, ElGamal)
+{
+    const auto encryption = crypto::algos::ElGamal_Encrypt(29, 23, 89, 57, 72);
+    const auto key = crypto::algos::ElGamal_Key_Generation(8, 11);
+    const auto signature = crypto::algos::ElGamal_Sign(9, 8, 5, 11, 2);
+
+    std::vector<std::uint8_t> buffer;
+    crypto::serial::write_elgamal_ciphertext(buffer, encryption);
+    crypto::serial::write_elgamal_public_key(buffer, key);
+    crypto::serial::write_elgamal_signature(buffer, signature);
+
+    crypto::serial::Reader reader(buffer);
+    std::pair<std::pair<mpz_class, mpz_class>, std::pair<std::uint64_t, std::uint64_t>> encryption_read{};
+    std::pair<mpz_class, std::pair<mpz_class, mpz_class>> key_read{};
+    std::pair<std::pair<mpz_class, mpz_class>, std::pair<mpz_class, mpz_class>> signature_read{};
+    ASSERT_TRUE(crypto::serial::read_elgamal_ciphertext(reader, encryption_read));
+    ASSERT_TRUE(crypto::serial::read_elgamal_public_key(reader, key_read));
+    ASSERT_TRUE(crypto::serial::read_elgamal_signature(reader, signature_read));
+    EXPECT_TRUE(reader.at_end());
+
+    EXPECT_EQ(encryption_read, encryption);
+    EXPECT_EQ(key_read, key);
+    EXPECT_EQ(signature_read, signature);
+    EXPECT_EQ(crypto::algos::ElGamal_Decrypt(29, 23, encryption_read), 72);
+}
+
+TEST(test_Serial_utils, EC_Point_and_numbers)
+{
+    // Zero, negative and multi byte values.
+    const std::pair<mpz_class, mpz_class> point(mpz_class(0), mpz_class("-123456789012345678901234567890"));
+
+    std::vector<std::uint8_t> buffer;
+    crypto::serial::write_ec_point(buffer, point);
+
+    // version, type, zero length, then (13 << 1 | 1) and 13 bytes.
+    ASSERT_EQ(buffer.size(), 2 + 1 + 1 + 13);
+    EXPECT_EQ(buffer[0], crypto::serial::Version);
+    EXPECT_EQ(buffer[1], static_cast<std::uint8_t>(crypto::serial::Type::EC_Point));
+
+    crypto::serial::Reader reader(buffer);
+    std::pair<mpz_class, mpz_class> point_read{};
+    ASSERT_TRUE(crypto::serial::read_ec_point(reader, point_read));
+    EXPECT_EQ(point_read, point);
+
+    // Views point into the caller's buffer.
+    crypto::serial::Reader view_reader(buffer);
+    ASSERT_TRUE(view_reader.begin(crypto::serial::Type::EC_Point));
+    const std::uint8_t* bytes = nullptr;
+    std::size_t length = 0;
+    bool negative = true;
+    ASSERT_TRUE(view_reader.number_view(bytes, length, negative));
+    EXPECT_EQ(length, 0);
+    EXPECT_FALSE(negative);
+    ASSERT_TRUE(view_reader.number_view(bytes, length, negative));
+    EXPECT_EQ(bytes, buffer.data() + 4);
+    EXPECT_EQ(length, 13);
+    EXPECT_TRUE(negative);
+}
+
+TEST(test_Serial_utils, EC_Point_Compressed)
+{
+    const std::pair<mpz_class, mpz_class> G(
+        mpz_class("79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798", 16),
+        mpz_class("483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8", 16));
+
+    std::vector<std::uint8_t> full;
+    crypto::serial::write_ec_point(full, G);
+
+    std::vector<std::uint8_t> buffer;
+    crypto::serial::write_ec_point_compressed(buffer, math::Compress_point_ECC(G));
+
+    // version, type, length, 32 bytes of x, parity
+    ASSERT_EQ(buffer.size(), 2 + 1 + 32 + 1);
+    EXPECT_LE(buffer.size(), full.size() / 2 + 2);
+
+    crypto::serial::Reader reader(buffer);
+    std::pair<mpz_class, bool> read{};
+    ASSERT_TRUE(crypto::serial::read_ec_point_compressed(reader, read));
+    EXPECT_TRUE(reader.at_end());
+    EXPECT_EQ(read, math::Compress_point_ECC(G));
+
+    // Anything but 0 or 1 for the parity.
+    buffer.back() = 2;
+    crypto::serial::Reader bad(buffer);
+    EXPECT_FALSE(crypto::serial::read_ec_point_compressed(bad, read));
+}
+
+TEST(test_Serial_utils, Malformed)
+{
+    std::vector<std::uint8_t> buffer;
+    crypto::serial::write_rsa_public_key(buffer, std::make_pair(mpz_class(65537), mpz_class("1000000000000000000000007")));
+
+    // Wrong type.
+    {
+        crypto::serial::Reader reader(buffer);
+        std::pair<mpz_class, mpz_class> point{};
+        EXPECT_FALSE(crypto::serial::read_ec_point(reader, point));
+        EXPECT_FALSE(reader.ok());
+    }
+
+    // Every truncation is rejected.
+    for (std::size_t size = 0; size < buffer.size(); ++size)
+    {
+        crypto::serial::Reader reader(buffer.data(), size);
+        std::pair<mpz_class, mpz_class> key{};
+        EXPECT_FALSE(crypto::serial::read_rsa_public_key(reader, key)) << "size " << size;
+    }
+
+    // Wrong version.
+    buffer[0] = crypto::serial::Version + 1;
+    crypto::serial::Reader reader(buffer);
+    std::pair<mpz_class, mpz_class> key{};
+    EXPECT_FALSE(crypto::serial::read_rsa_public_key(reader, key));
+}
@@ -22,6 +22,51 @@ TEST(test_Zero_Knowledge_Proof, Pub_key_Calculation)
     {
         std::cout << key << std::endl;
     }
+    EXPECT_EQ(pub_keys, (std::vector<mpz_class>{ 58, 67 }));
+}
+
+TEST(test_Zero_Knowledge_Proof, Pub_key_Calculation_Many_Provers)
+{
+    // N = pq with Blum primes p = 2^127 - 1, q = 2^89 - 1
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 127);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+    const mpz_class modulo(p * q);
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    std::vector<std::vector<mpz_class>> secret_keys(3000);
+    for (std::size_t i = 0; i < secret_keys.size(); ++i)
+    {
+        for (std::size_t j = 0; j < 1 + i % 4; ++j)
+        {
+            secret_keys[i].emplace_back(random.get_z_range(p - 2) + 2);
+        }
+    }
+
+    const auto pub_keys = crypto::algos::Calculate_Public_Keys(secret_keys, modulo);
+    ASSERT_EQ(pub_keys.size(), secret_keys.size());
+    for (std::size_t i = 0; i < secret_keys.size(); ++i)
+    {
+        ASSERT_EQ(pub_keys[i].size(), secret_keys[i].size());
+        for (std::size_t j = 0; j < secret_keys[i].size(); ++j)
+        {
+            ASSERT_EQ((secret_keys[i][j] * secret_keys[i][j] * pub_keys[i][j]) % modulo, 1);
+        }
+    }
+
+    // The small example gives the same keys as one prover.
+    const auto small = crypto::algos::Calculate_Public_Keys(
+        std::vector<std::vector<mpz_class>>{ { 9, 10 }, { 10 } }, 77);
+    EXPECT_EQ(small, (std::vector<std::vector<mpz_class>>{ { 58, 67 }, { 67 } }));
+
+    // A key sharing a factor with N has no public key.
+    EXPECT_TRUE(crypto::algos::Calculate_Public_Keys(
+        std::vector<std::vector<mpz_class>>{ { 9 }, { 7 } }, 77).empty());
 }
 
 
@@ -112,3 +157,233 @@ TEST(test_Zero_Knowledge_Proof, Exam)
                             mat);
     EXPECT_TRUE(satisfied);
 }
+
+TEST(test_Zero_Knowledge_Proof, Nobody_knows_priv_key_Large_Keys)
+{
+    // N = pq with p = 2^127 - 1, q = 2^89 - 1. The keys don't fit in a machine word.
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 127);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+    const mpz_class N(p * q);
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    std::vector<mpz_class> PrivKey(20);
+    for (auto& key : PrivKey)
+    {
+        key = random.get_z_range(p - 2) + 2;
+    }
+    const auto PubKey = crypto::algos::Calculate_Public_Keys(PrivKey, N);
+
+    std::vector<mpz_class> random_numbers(40);
+    std::vector<std::vector<size_t>> mat(random_numbers.size(), std::vector<size_t>(PrivKey.size()));
+    for (size_t i = 0; i < random_numbers.size(); ++i)
+    {
+        random_numbers[i] = random.get_z_range(N - 2) + 2;
+        for (auto& bit : mat[i])
+        {
+            bit = mpz_class(random.get_z_bits(1)).get_ui();
+        }
+    }
+
+    EXPECT_TRUE(crypto::algos::Zero_Knowledge_Proof(N, PubKey, PrivKey, random_numbers, mat));
+
+    // Exponents above 1 take the general path.
+    mat[0][0] = 2;
+    mat[1][3] = 3;
+    EXPECT_TRUE(crypto::algos::Zero_Knowledge_Proof(N, PubKey, PrivKey, random_numbers, mat));
+
+    // Somebody with a wrong key is caught by any row that uses it.
+    auto forged = PrivKey;
+    forged[5] += 1;
+    mat[2][5] = 1;
+    EXPECT_FALSE(crypto::algos::Zero_Knowledge_Proof(N, PubKey, forged, random_numbers, mat));
+}
+
+TEST(test_Zero_Knowledge_Proof, Verify_Batch)
+{
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 127);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+    const mpz_class N(p * q);
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    // 64 provers with 16 keys each and 80 rounds, enough rows for the subset product tables.
+    std::vector<std::vector<mpz_class>> PrivKeys(64, std::vector<mpz_class>(16));
+    for (auto& keys : PrivKeys)
+    {
+        for (auto& key : keys)
+        {
+            key = random.get_z_range(p - 2) + 2;
+        }
+    }
+    const auto PubKeys = crypto::algos::Calculate_Public_Keys(PrivKeys, N);
+    ASSERT_EQ(PubKeys.size(), PrivKeys.size());
+
+    std::vector<crypto::algos::ZKP_Transcript> transcripts;
+    for (size_t k = 0; k < PrivKeys.size(); ++k)
+    {
+        std::vector<mpz_class> random_numbers(80);
+        std::vector<std::vector<size_t>> mat(random_numbers.size(), std::vector<size_t>(PrivKeys[k].size()));
+        for (size_t i = 0; i < random_numbers.size(); ++i)
+        {
+            random_numbers[i] = random.get_z_range(N - 2) + 2;
+            for (auto& bit : mat[i])
+            {
+                bit = mpz_class(random.get_z_bits(1)).get_ui();
+            }
+        }
+        transcripts.push_back(crypto::algos::ZKP_Prove(N, PubKeys[k], PrivKeys[k], random_numbers, mat));
+    }
+
+    // Break a few of them in different ways.
+    transcripts[3].responses[17] += 1;                                 // wrong answer
+    transcripts[10].PubKey = PubKeys[11];                              // someone else's identity
+    transcripts[20].responses.pop_back();                              // truncated
+    transcripts[30].challenges[0].pop_back();                          // malformed row
+    transcripts[40].commitments[0] = 0;                                // x = 0, y = 0 proves nothing
+    transcripts[40].responses[0]   = 0;
+
+    const std::vector<bool> accepted = crypto::algos::ZKP_Verify_Batch(transcripts);
+    ASSERT_EQ(accepted.size(), transcripts.size());
+    for (size_t k = 0; k < transcripts.size(); ++k)
+    {
+        const bool broken = k == 3 || k == 10 || k == 20 || k == 30 || k == 40;
+        EXPECT_EQ(accepted[k], !broken) << "prover " << k;
+        EXPECT_EQ(accepted[k], crypto::algos::ZKP_Verify(transcripts[k]));
+    }
+
+    EXPECT_TRUE(crypto::algos::ZKP_Verify_Batch({}).empty());
+}
+
+TEST(test_Zero_Knowledge_Proof, Fiat_Shamir)
+{
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 127);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+    const mpz_class N(p * q);
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    std::vector<std::vector<mpz_class>> PrivKeys(16);
+    for (size_t k = 0; k < PrivKeys.size(); ++k)
+    {
+        PrivKeys[k].resize(1 + k % 6);
+        for (auto& key : PrivKeys[k])
+        {
+            key = random.get_z_range(p - 2) + 2;
+        }
+    }
+    const auto PubKeys = crypto::algos::Calculate_Public_Keys(PrivKeys, N);
+
+    // What the verifier knows of every prover, and the session nonces it hands out.
+    std::vector<crypto::algos::ZKP_Statement> expected(PrivKeys.size());
+    for (size_t k = 0; k < PrivKeys.size(); ++k)
+    {
+        expected[k] = { N, PubKeys[k], "session " + std::to_string(k) };
+    }
+
+    std::vector<std::vector<std::uint8_t>> proofs;
+    for (size_t k = 0; k < PrivKeys.size(); ++k)
+    {
+        proofs.push_back(crypto::algos::ZKP_Prove_NonInteractive(N, PubKeys[k], PrivKeys[k], expected[k].context));
+        ASSERT_FALSE(proofs.back().empty());
+        EXPECT_TRUE(crypto::algos::ZKP_Verify_NonInteractive(expected[k], proofs.back()));
+    }
+
+    // Fresh commitments every time: proving the same statement twice gives different proofs.
+    const auto again = crypto::algos::ZKP_Prove_NonInteractive(N, PubKeys[0], PrivKeys[0], expected[0].context);
+    EXPECT_NE(again, proofs[0]);
+    EXPECT_TRUE(crypto::algos::ZKP_Verify_NonInteractive(expected[0], again));
+
+    // The challenges are recomputed from the blob, and cover at least 128 bits.
+    crypto::algos::ZKP_Transcript transcript{};
+    ASSERT_TRUE(crypto::algos::ZKP_Read_Proof(proofs[5].data(), proofs[5].size(), expected[5].context, transcript));
+    EXPECT_EQ(transcript.PubKey, PubKeys[5]);
+    EXPECT_GE(transcript.challenges.size() * transcript.PubKey.size(), crypto::algos::ZKP_Fiat_Shamir_Bits);
+
+    // Somebody without the private keys.
+    auto forged = PrivKeys[1];
+    forged[0] += 1;
+    proofs[1] = crypto::algos::ZKP_Prove_NonInteractive(N, PubKeys[1], forged, expected[1].context);
+
+    // A changed response.
+    proofs[2].back() ^= 1;
+
+    // A changed commitment changes the challenges, and the responses no longer fit.
+    {
+        crypto::algos::ZKP_Transcript changed{};
+        ASSERT_TRUE(crypto::algos::ZKP_Read_Proof(proofs[3].data(), proofs[3].size(), expected[3].context, changed));
+        changed.commitments[0] = (changed.commitments[0] * 4) % N;
+
+        std::vector<std::uint8_t> blob;
+        crypto::serial::Writer writer(blob);
+        writer.begin(crypto::serial::Type::ZKP_Proof);
+        writer.number(changed.N);
+        writer.word(changed.PubKey.size());
+        for (const auto& key : changed.PubKey) { writer.number(key); }
+        writer.word(changed.commitments.size());
+        for (const auto& commitment : changed.commitments) { writer.number(commitment); }
+        // y_0 * 2 answers x_0 * 4 for the old challenge row.
+        changed.responses[0] = (changed.responses[0] * 2) % N;
+        for (const auto& response : changed.responses) { writer.number(response); }
+        proofs[3] = blob;
+    }
+
+    // Trailing and missing bytes.
+    proofs[4].push_back(0);
+    proofs[6].pop_back();
+
+    // Too few challenge bits.
+    proofs[7] = crypto::algos::ZKP_Prove_NonInteractive(N, PubKeys[7], PrivKeys[7], expected[7].context, 8);
+    EXPECT_TRUE(crypto::algos::ZKP_Verify_NonInteractive(expected[7], proofs[7], 8));
+
+    // Not a proof at all.
+    proofs[8] = std::vector<std::uint8_t>{ 1, 8, 0xFF };
+
+    // A valid proof, but for a key pair the prover made up instead of the expected identity.
+    {
+        std::vector<mpz_class> own(PrivKeys[9].size());
+        for (auto& key : own)
+        {
+            key = random.get_z_range(p - 2) + 2;
+        }
+        const auto own_public = crypto::algos::Calculate_Public_Keys(own, N);
+        proofs[9] = crypto::algos::ZKP_Prove_NonInteractive(N, own_public, own, expected[9].context);
+        EXPECT_TRUE(crypto::algos::ZKP_Verify_NonInteractive({ N, own_public, expected[9].context }, proofs[9]));
+    }
+
+    // A captured proof replayed in another session.
+    proofs[10] = proofs[11];
+
+    const auto accepted = crypto::algos::ZKP_Verify_NonInteractive_Batch(expected, proofs);
+    ASSERT_EQ(accepted.size(), proofs.size());
+    for (size_t k = 0; k < proofs.size(); ++k)
+    {
+        const bool broken = (k >= 1 && k <= 4) || (k >= 6 && k <= 10);
+        EXPECT_EQ(accepted[k], !broken) << "proof " << k;
+    }
+
+    // Same proof, right keys, wrong context; and a modulus the verifier doesn't know.
+    EXPECT_FALSE(crypto::algos::ZKP_Verify_NonInteractive({ N, PubKeys[11], "another session" }, proofs[11]));
+    EXPECT_FALSE(crypto::algos::ZKP_Verify_NonInteractive({ N + 2, PubKeys[11], expected[11].context }, proofs[11]));
+
+    // A batch with the wrong number of statements.
+    EXPECT_EQ(crypto::algos::ZKP_Verify_NonInteractive_Batch({}, proofs), std::vector<bool>(proofs.size(), false));
+
+    // Mismatched keys give no proof.
+    EXPECT_TRUE(crypto::algos::ZKP_Prove_NonInteractive(N, PubKeys[2], PrivKeys[3], "").empty());
+}
@@ -0,0 +1,94 @@
+#include "../algorithms/Zero_Knowledge_Session.hpp"
+
+// Standard C/C++
+#include <vector>
+
+// Google
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(test_Zero_Knowledge_Session, Many_Sessions)
+{
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 127);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+    const mpz_class N(p * q);
+
+    gmp_randclass random(gmp_randinit_default);
+    random.seed(608);
+
+    std::vector<std::vector<mpz_class>> PrivKeys(2000, std::vector<mpz_class>(4));
+    for (auto& keys : PrivKeys)
+    {
+        for (auto& key : keys)
+        {
+            key = random.get_z_range(p - 2) + 2;
+        }
+    }
+    const auto PubKeys = crypto::algos::Calculate_Public_Keys(PrivKeys, N);
+
+    // 40 rounds of 4 bits each.
+    crypto::algos::ZKP_Session_Engine engine(40, 4);
+    for (size_t k = 0; k < PrivKeys.size(); ++k)
+    {
+        auto keys = PrivKeys[k];
+        if (k % 97 == 5)
+        {
+            keys[k % 4] += 1; // doesn't know the private key
+        }
+        if (k % 131 == 7)
+        {
+            keys.pop_back();  // not even the right number of keys
+        }
+        EXPECT_EQ(engine.add(N, PubKeys[k], keys), k);
+    }
+    EXPECT_EQ(engine.sessions(), PrivKeys.size());
+
+    const std::vector<bool> accepted = engine.run();
+    ASSERT_EQ(accepted.size(), PrivKeys.size());
+    for (size_t k = 0; k < accepted.size(); ++k)
+    {
+        const bool cheating = k % 97 == 5 || k % 131 == 7;
+        EXPECT_EQ(accepted[k], !cheating) << "session " << k;
+    }
+    EXPECT_EQ(engine.sessions(), 0u);
+
+    // No pipelining, on a pool of one thread. 32 rounds of 4 bits is exactly the minimum.
+    crypto::exec::ThreadPool pool(1);
+    crypto::algos::ZKP_Session_Engine serial(32, 1, pool);
+    serial.add(N, PubKeys[0], PrivKeys[0]);
+    serial.add(N, PubKeys[1], PrivKeys[2]);
+    EXPECT_EQ(serial.run(), (std::vector<bool>{ true, false }));
+    EXPECT_TRUE(serial.run().empty());
+}
+
+TEST(test_Zero_Knowledge_Session, Soundness)
+{
+    mpz_class p{};
+    mpz_class q{};
+    mpz_ui_pow_ui(p.get_mpz_t(), 2, 127);
+    mpz_ui_pow_ui(q.get_mpz_t(), 2, 89);
+    p -= 1;
+    q -= 1;
+    const mpz_class N(p * q);
+
+    const std::vector<std::vector<mpz_class>> PrivKeys = { { 12345, 67890, 13579, 24680 } };
+    const auto PubKeys = crypto::algos::Calculate_Public_Keys(PrivKeys, N);
+    const std::vector<mpz_class> no_keys{};
+
+    // Without keys every response would check out, with a secret or without.
+    crypto::algos::ZKP_Session_Engine engine(40);
+    EXPECT_EQ(engine.add(N, no_keys, no_keys), 0u);
+    EXPECT_EQ(engine.add(N, PubKeys[0], std::vector<mpz_class>(PrivKeys[0].begin(), PrivKeys[0].end() - 1)), 1u);
+    EXPECT_EQ(engine.add(N, PubKeys[0], PrivKeys[0]), 2u);
+    EXPECT_EQ(engine.add(3, PubKeys[0], PrivKeys[0]), 3u);
+    EXPECT_EQ(engine.run(), (std::vector<bool>{ false, false, true, false }));
+
+    // 31 rounds of 4 bits are one short of the minimum, even with the right keys.
+    crypto::algos::ZKP_Session_Engine short_engine(31);
+    short_engine.add(N, PubKeys[0], PrivKeys[0]);
+    EXPECT_EQ(short_engine.run(), (std::vector<bool>{ false }));
+}
@@ -47,6 +47,15 @@ static inline std::pair<std::pair<mpz_class, mpz_class>, std::uint64_t> Get_Publ
     return std::make_pair(std::make_pair(PK_A, PK_B), gen);
 }
 
+// Same as above, with the generator's exponentiation table built once by the caller.
+static inline std::pair<std::pair<mpz_class, mpz_class>, std::uint64_t> Get_Public_Keys(const std::uint64_t       a,          // a's private key
+                                                                                        const std::uint64_t       b,          // b's private key
+                                                                                        const math::FixedBasePow& generator)  // g^x mod p
+{
+    return std::make_pair(std::make_pair(generator.pow(a), generator.pow(b)),
+                          generator.base().get_ui());
+}
+
 } // namespace utils
 } // namespace crypto
 #endif // CRYPTO_UTILS_HPP
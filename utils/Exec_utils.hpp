@@ -0,0 +1,507 @@
+#ifndef EXEC_UTILS_HPP
+#define EXEC_UTILS_HPP
+
+// Standard C/C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace crypto
+{
+namespace exec
+{
+//! @description: Work-stealing thread pool.
+//!               Every worker owns a deque. A worker pushes and pops its own tasks at the back
+//!               (most recent first, good for cache), and steals the oldest task from the front of
+//!               another worker's deque when it runs out. Tasks submitted from outside the pool go
+//!               to the workers round robin.
+//!               A task should not throw: nobody is waiting for it. If one does, the exception is
+//!               reported on stderr and dropped, so the worker survives. TaskGroup tasks hand their
+//!               exceptions to the group instead.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(const std::size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+        : queues_(std::max<std::size_t>(threads, 1))
+    {
+        workers_.reserve(queues_.size());
+        for (std::size_t i = 0; i < queues_.size(); ++i)
+        {
+            workers_.emplace_back([this, i]() { run(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    std::size_t size() const { return workers_.size(); }
+
+    void
+    submit(Task task)
+    {
+        const auto self = current_worker();
+        const std::size_t index = self < queues_.size()
+                                ? self
+                                : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index].mutex);
+            pending_.fetch_add(1, std::memory_order_release);
+            queues_[index].tasks.emplace_back(std::move(task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+
+    // Run one queued task on the calling thread. Used by waiters so they help instead of blocking.
+    // Returns false if there was nothing to run.
+    bool
+    run_one()
+    {
+        Task task;
+        const auto self = current_worker();
+        if (!take(self < queues_.size() ? self : 0, task))
+        {
+            return false;
+        }
+        invoke(task);
+        return true;
+    }
+
+    // Index of the calling worker in its pool, or a value >= size() for threads outside the pool.
+    std::size_t
+    current_worker() const
+    {
+        return worker_pool() == this ? worker_index() : static_cast<std::size_t>(-1);
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    static const ThreadPool*& worker_pool()
+    {
+        static thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static std::size_t& worker_index()
+    {
+        static thread_local std::size_t index = 0;
+        return index;
+    }
+
+    static void
+    invoke(Task& task)
+    {
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Uncaught exception in a pool task: " << e.what() << std::endl;
+        }
+        catch (...)
+        {
+            std::cerr << "Uncaught exception in a pool task" << std::endl;
+        }
+    }
+
+    // Own queue from the back first, then steal from the front of the others.
+    bool
+    take(const std::size_t self, Task& task)
+    {
+        {
+            auto& own = queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; i < queues_.size(); ++i)
+        {
+            auto& victim = queues_[(self + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void
+    run(const std::size_t index)
+    {
+        worker_pool()  = this;
+        worker_index() = index;
+
+        Task task;
+        for (;;)
+        {
+            if (take(index, task))
+            {
+                invoke(task);
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this]()
+            {
+                return stopping_ || pending_.load(std::memory_order_acquire) > 0;
+            });
+
+            if (stopping_ && pending_.load(std::memory_order_acquire) == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    std::vector<Queue>       queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<std::size_t> next_queue_{ 0 };
+    std::atomic<std::size_t> pending_{ 0 };
+
+    std::mutex              sleep_mutex_;
+    std::condition_variable wake_;
+    bool                    stopping_ = false;
+};
+
+// Pool shared by the whole library, one worker per core. Created on first use.
+static inline ThreadPool&
+default_pool()
+{
+    static ThreadPool pool{};
+    return pool;
+}
+
+//! @description: A set of tasks that can be waited on together.
+//!               wait() runs queued tasks on the calling thread while it waits, so groups can be
+//!               nested inside pool tasks without running out of workers.
+//!               A task that throws still counts as done. The first exception is kept and rethrown
+//!               by wait(), after every task of the group has finished; later ones are dropped.
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool& pool = default_pool())
+        : pool_(pool)
+    {
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // An exception nobody waited for is dropped, destructors can't throw.
+    ~TaskGroup()
+    {
+        wait_all();
+    }
+
+    template<typename Function>
+    void
+    run(Function&& function)
+    {
+        remaining_.fetch_add(1, std::memory_order_relaxed);
+        try
+        {
+            pool_.submit([this, function = std::forward<Function>(function)]() mutable
+            {
+                const Finished finished{ *this };
+                try
+                {
+                    function();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_)
+                    {
+                        error_ = std::current_exception();
+                    }
+                }
+            });
+        }
+        catch (...)
+        {
+            finish();
+            throw;
+        }
+    }
+
+    void
+    wait()
+    {
+        wait_all();
+
+        std::exception_ptr error{};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(error, error_);
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    // Marks the task done however it ends.
+    struct Finished
+    {
+        TaskGroup& group;
+
+        ~Finished() { group.finish(); }
+    };
+
+    // Decrement under the lock, so wait() can't return (and destroy the group) while the task
+    // still holds it.
+    void
+    finish()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            done_.notify_all();
+        }
+    }
+
+    void
+    wait_all()
+    {
+        while (remaining_.load(std::memory_order_acquire) > 0)
+        {
+            if (pool_.run_one())
+            {
+                continue;
+            }
+
+            // Nothing left to help with, the last tasks are running on other workers.
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait_for(lock, std::chrono::milliseconds(1), [this]()
+            {
+                return remaining_.load(std::memory_order_acquire) == 0;
+            });
+        }
+
+        // The last task may still be unlocking.
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+
+    ThreadPool&              pool_;
+    std::atomic<std::size_t> remaining_{ 0 };
+    std::mutex               mutex_;
+    std::condition_variable  done_;
+    std::exception_ptr       error_{};
+};
+
+//! @description: Call function(first, last) over [begin, end) in chunks of at most `grain`
+//!               indices, spread over the pool. Returns when every chunk is done.
+//!               A grain of 0 picks about 4 chunks per worker.
+//!               If a chunk throws, the first exception is rethrown once every chunk is done.
+template<typename Function>
+static inline void
+parallel_for(const std::uint64_t begin,
+             const std::uint64_t end,
+             Function&&          function,
+             std::uint64_t       grain = 0,
+             ThreadPool&         pool  = default_pool())
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    const std::uint64_t count = end - begin;
+    if (grain == 0)
+    {
+        grain = std::max<std::uint64_t>(1, count / (4 * pool.size()));
+    }
+
+    // Small ranges aren't worth a task.
+    if (count <= grain)
+    {
+        function(begin, end);
+        return;
+    }
+
+    TaskGroup group(pool);
+    for (std::uint64_t first = begin; first < end; first += grain)
+    {
+        const std::uint64_t last = std::min(end, first + grain);
+        group.run([&function, first, last]() { function(first, last); });
+    }
+    group.wait();
+}
+
+//! @description: Bounded lock-free multi-producer/multi-consumer queue (Vyukov).
+//!               Every cell carries a sequence number that tells producers and consumers whose
+//!               turn it is, so a push or pop is one CAS on the tail or head plus the move.
+//!               The capacity is rounded up to a power of two.
+template<typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(const std::size_t capacity)
+        : capacity_(round_up(capacity)),
+          mask_(capacity_ - 1),
+          cells_(new Cell[capacity_])
+    {
+        for (std::size_t i = 0; i < capacity_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    std::size_t capacity() const { return capacity_; }
+
+    // Only a hint while other threads are pushing or popping.
+    std::size_t
+    size() const
+    {
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    // Returns false (and leaves value alone) if the queue is full.
+    bool
+    try_push(T&& value)
+    {
+        Cell* cell = nullptr;
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0)
+            {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty.
+    bool
+    try_pop(T& value)
+    {
+        Cell* cell = nullptr;
+        std::size_t position = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (difference == 0)
+            {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(position + capacity_, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T                        value;
+    };
+
+    static std::size_t
+    round_up(const std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const std::size_t       capacity_;
+    const std::size_t       mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Producers and consumers on separate cache lines.
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };
+    alignas(64) std::atomic<std::size_t> head_{ 0 };
+};
+
+} // namespace exec
+} // namespace crypto
+#endif // EXEC_UTILS_HPP
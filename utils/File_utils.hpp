@@ -0,0 +1,186 @@
+#ifndef FILE_UTILS_HPP
+#define FILE_UTILS_HPP
+
+// Standard C/C++
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace file
+{
+//! @description: Memory mapping of a whole file. The page cache does the actual I/O.
+//!               The mapping and the file descriptor are released when the object goes away.
+//!               Failures leave the object closed (is_open() == false) and print the reason.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+    {
+        swap(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // Map an existing file for reading.
+    static MappedFile
+    open_read(const std::string& path)
+    {
+        MappedFile mapped{};
+        mapped.fd_ = ::open(path.c_str(), O_RDONLY);
+        if (mapped.fd_ < 0)
+        {
+            std::cerr << "Could not open " << path << std::endl;
+            return MappedFile{};
+        }
+
+        struct stat info{};
+        if (::fstat(mapped.fd_, &info) != 0)
+        {
+            std::cerr << "Could not stat " << path << std::endl;
+            return MappedFile{};
+        }
+
+        mapped.size_ = static_cast<std::size_t>(info.st_size);
+        if (!mapped.map(PROT_READ))
+        {
+            std::cerr << "Could not map " << path << std::endl;
+            return MappedFile{};
+        }
+
+        return mapped;
+    }
+
+    // Create (or truncate) a file of exactly `size` bytes and map it for writing.
+    static MappedFile
+    create(const std::string& path, const std::size_t size)
+    {
+        MappedFile mapped{};
+        mapped.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (mapped.fd_ < 0)
+        {
+            std::cerr << "Could not create " << path << std::endl;
+            return MappedFile{};
+        }
+
+        if (::ftruncate(mapped.fd_, static_cast<off_t>(size)) != 0)
+        {
+            std::cerr << "Could not resize " << path << std::endl;
+            return MappedFile{};
+        }
+
+        mapped.size_ = size;
+        if (!mapped.map(PROT_READ | PROT_WRITE))
+        {
+            std::cerr << "Could not map " << path << std::endl;
+            return MappedFile{};
+        }
+
+        return mapped;
+    }
+
+    bool is_open() const { return fd_ >= 0; }
+
+    std::size_t size() const { return size_; }
+
+    const std::uint8_t* data() const { return static_cast<const std::uint8_t*>(map_); }
+    std::uint8_t*       data()       { return static_cast<std::uint8_t*>(map_); }
+
+    // Flush written pages to the file.
+    bool
+    sync()
+    {
+        return map_ == nullptr || ::msync(map_, size_, MS_SYNC) == 0;
+    }
+
+    void
+    close()
+    {
+        if (map_ != nullptr)
+        {
+            ::munmap(map_, size_);
+            map_ = nullptr;
+        }
+
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+
+        size_ = 0;
+    }
+
+private:
+    bool
+    map(const int protection)
+    {
+        // Empty files can't be mapped, but are still valid.
+        if (size_ == 0)
+        {
+            return true;
+        }
+
+        void* address = ::mmap(nullptr, size_, protection, MAP_SHARED, fd_, 0);
+        if (address == MAP_FAILED)
+        {
+            return false;
+        }
+
+        map_ = address;
+        return true;
+    }
+
+    void
+    swap(MappedFile& other) noexcept
+    {
+        std::swap(fd_, other.fd_);
+        std::swap(map_, other.map_);
+        std::swap(size_, other.size_);
+    }
+
+    int         fd_   = -1;
+    void*       map_  = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Whether both paths name the same existing file, including through links. Writing to one of
+// them with MappedFile::create truncates the other.
+static inline bool
+same_file(const std::string& first, const std::string& second)
+{
+    struct stat a{};
+    struct stat b{};
+    if (::stat(first.c_str(), &a) != 0 || ::stat(second.c_str(), &b) != 0)
+    {
+        return false;
+    }
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+} // namespace file
+#endif // FILE_UTILS_HPP
@@ -0,0 +1,199 @@
+#ifndef HASH_UTILS_HPP
+#define HASH_UTILS_HPP
+
+// Standard C/C++
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace crypto
+{
+namespace hash
+{
+//! @description: SHA-256 (FIPS 180-4). Feed the message with update() in as many pieces as
+//!               needed, then finish() pads it and returns the digest. reset() to hash another one.
+class SHA256
+{
+public:
+    static constexpr std::size_t Digest_Size = 32;
+    using Digest = std::array<std::uint8_t, Digest_Size>;
+
+    SHA256()
+    {
+        reset();
+    }
+
+    void
+    reset()
+    {
+        state_ = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+        buffered_ = 0;
+        length_   = 0;
+    }
+
+    void
+    update(const std::uint8_t* data, std::size_t size)
+    {
+        length_ += size;
+
+        // Top up a partial block first.
+        if (buffered_ > 0)
+        {
+            const std::size_t take = std::min(size, buffer_.size() - buffered_);
+            std::memcpy(buffer_.data() + buffered_, data, take);
+            buffered_ += take;
+            data += take;
+            size -= take;
+
+            if (buffered_ < buffer_.size())
+            {
+                return;
+            }
+            compress(buffer_.data());
+            buffered_ = 0;
+        }
+
+        // Whole blocks straight from the input.
+        for (; size >= buffer_.size(); data += buffer_.size(), size -= buffer_.size())
+        {
+            compress(data);
+        }
+
+        if (size > 0)
+        {
+            std::memcpy(buffer_.data(), data, size);
+            buffered_ = size;
+        }
+    }
+
+    void update(const std::vector<std::uint8_t>& data) { update(data.data(), data.size()); }
+
+    void update(const std::string& data) { update(reinterpret_cast<const std::uint8_t*>(data.data()), data.size()); }
+
+    Digest
+    finish()
+    {
+        const std::uint64_t bits = length_ * 8;
+
+        // 0x80, zeros up to 56 mod 64, then the message length in bits (big endian).
+        std::array<std::uint8_t, 72> padding{};
+        padding[0] = 0x80;
+        const std::size_t zeros = (buffered_ < 56 ? 56 : 120) - buffered_;
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            padding[zeros + i] = static_cast<std::uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(padding.data(), zeros + 8);
+
+        Digest digest{};
+        for (std::size_t i = 0; i < state_.size(); ++i)
+        {
+            digest[4 * i]     = static_cast<std::uint8_t>(state_[i] >> 24);
+            digest[4 * i + 1] = static_cast<std::uint8_t>(state_[i] >> 16);
+            digest[4 * i + 2] = static_cast<std::uint8_t>(state_[i] >> 8);
+            digest[4 * i + 3] = static_cast<std::uint8_t>(state_[i]);
+        }
+        return digest;
+    }
+
+private:
+    static std::uint32_t rotr(const std::uint32_t x, const unsigned n) { return (x >> n) | (x << (32 - n)); }
+
+    void
+    compress(const std::uint8_t* block)
+    {
+        static constexpr std::uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        std::uint32_t w[64];
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            w[i] = (static_cast<std::uint32_t>(block[4 * i]) << 24) |
+                   (static_cast<std::uint32_t>(block[4 * i + 1]) << 16) |
+                   (static_cast<std::uint32_t>(block[4 * i + 2]) << 8) |
+                    static_cast<std::uint32_t>(block[4 * i + 3]);
+        }
+        for (std::size_t i = 16; i < 64; ++i)
+        {
+            const std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        std::uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            const std::uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            const std::uint32_t ch = (e & f) ^ (~e & g);
+            const std::uint32_t t1 = h + S1 + ch + K[i] + w[i];
+            const std::uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            const std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            const std::uint32_t t2 = S0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+        state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+    }
+
+    std::array<std::uint32_t, 8> state_{};
+    std::array<std::uint8_t, 64> buffer_{};
+    std::size_t                  buffered_ = 0;
+    std::uint64_t                length_   = 0;
+};
+
+static inline SHA256::Digest
+sha256(const std::uint8_t* data, const std::size_t size)
+{
+    SHA256 hasher;
+    hasher.update(data, size);
+    return hasher.finish();
+}
+
+static inline SHA256::Digest
+sha256(const std::string& data)
+{
+    SHA256 hasher;
+    hasher.update(data);
+    return hasher.finish();
+}
+
+// Lower case hex of a digest.
+static inline std::string
+to_hex(const SHA256::Digest& digest)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2 * digest.size());
+    for (const auto byte : digest)
+    {
+        hex.push_back(digits[byte >> 4]);
+        hex.push_back(digits[byte & 0x0F]);
+    }
+    return hex;
+}
+
+} // namespace hash
+} // namespace crypto
+#endif // HASH_UTILS_HPP
@@ -0,0 +1,523 @@
+#ifndef KEYSTORE_UTILS_HPP
+#define KEYSTORE_UTILS_HPP
+
+// Standard C/C++
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// GMP
+#include <gmpxx.h>
+
+// Internal
+#include "File_utils.hpp"
+#include "Math_utils.hpp"
+
+namespace crypto
+{
+namespace keystore
+{
+// On-disk keystore. Numbers are stored as raw GMP limbs in native byte order, so an opened
+// keystore hands them out as read-only mpz views over the mapping (or copies the limbs),
+// without parsing or recomputing anything.
+//
+// Layout (every offset is a multiple of 8):
+//   header    | magic "CS608KEY", version, limb size, byte order marker, entry count, file size
+//   directory | one Directory_Record per entry, sorted by name
+//   tables    | one Number_Record per number of an entry
+//   limbs     | the limbs of every number
+// The file is only valid on machines with the same limb size and byte order.
+static constexpr char          Magic[8]    = { 'C', 'S', '6', '0', '8', 'K', 'E', 'Y' };
+static constexpr std::uint32_t Version     = 1;
+static constexpr std::uint32_t Byte_Order  = 0x01020304;
+static constexpr std::size_t   Name_Length = 32;
+
+enum class Kind : std::uint32_t
+{
+    Numbers          = 0, // anything else
+    RSA_Key          = 1, // {n, e, d, p, q, d mod (p - 1), d mod (q - 1), q^-1 mod p}
+    Group            = 2, // {modulo, generator, R^2 mod modulo, -modulo^-1 mod 2^limb bits}
+    Curve            = 3, // {modulo, a, b, generator x, generator y, order}
+    Fixed_Base_Table = 4, // {modulo, base, exponent bits, window, table entries...}
+};
+
+struct Header
+{
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t limb_bytes;
+    std::uint32_t byte_order;
+    std::uint32_t reserved;
+    std::uint64_t entries;
+    std::uint64_t file_size;
+};
+
+struct Directory_Record
+{
+    char          name[Name_Length];
+    std::uint32_t kind;
+    std::uint32_t count;        // numbers in the entry
+    std::uint64_t table_offset; // first Number_Record
+};
+
+struct Number_Record
+{
+    std::uint64_t limb_offset;
+    std::int64_t  size; // signed limb count, same as mpz _mp_size
+};
+
+// Precomputed RSA private key. Decrypting with p, q and the CRT values needs no setup.
+struct RSA_Key
+{
+    mpz_class n, e, d;
+    mpz_class p, q;
+    mpz_class dP, dQ, qInv;
+};
+
+// Group for ElGamal/Diffie-Hellman with its Montgomery constants (see Keystore::montgomery).
+struct Group
+{
+    mpz_class modulo, generator;
+    mpz_class montgomery_R2;      // R^2 mod modulo, R = 2^(limb bits * limbs of modulo)
+    mpz_class montgomery_inverse; // -modulo^-1 mod 2^(limb bits)
+};
+
+struct Curve
+{
+    mpz_class modulo, a, b;
+    std::pair<mpz_class, mpz_class> generator;
+    mpz_class order;
+};
+
+//! @description: Collects entries and writes them to a keystore file.
+//!               All of the precomputation happens here, once.
+class Builder
+{
+public:
+    // Store arbitrary numbers. An entry with the same name is replaced.
+    void
+    add(const std::string& name, const Kind kind, std::vector<mpz_class> numbers)
+    {
+        assert(!name.empty() && name.size() < Name_Length);
+        entries_[name] = std::make_pair(kind, std::move(numbers));
+    }
+
+    // false, and nothing is added, if e isn't coprime to phi(n) or q has no inverse mod p.
+    bool
+    add_rsa_key(const std::string& name, const mpz_class& p, const mpz_class& q, const mpz_class& e)
+    {
+        const mpz_class n(p * q);
+        const mpz_class phi_n((p - 1) * (q - 1));
+
+        mpz_class d{};
+        mpz_class qInv{};
+        if (!math::Inverse_Modulo(d, e, phi_n) || !math::Inverse_Modulo(qInv, q, p))
+        {
+            return false;
+        }
+
+        add(name, Kind::RSA_Key, { n, e, d, p, q,
+                                   mpz_class(d % (p - 1)),
+                                   mpz_class(d % (q - 1)),
+                                   qInv });
+        return true;
+    }
+
+    void
+    add_group(const std::string& name, const mpz_class& modulo, const mpz_class& generator)
+    {
+        const std::size_t limb_bits = 8 * sizeof(mp_limb_t);
+        const std::size_t limbs = mpz_size(modulo.get_mpz_t());
+
+        mpz_class R2{};
+        mpz_setbit(R2.get_mpz_t(), 2 * limb_bits * limbs);
+        R2 %= modulo;
+
+        // Only odd moduli have Montgomery constants.
+        mpz_class inverse{};
+        if (mpz_odd_p(modulo.get_mpz_t()))
+        {
+            mpz_class word{};
+            mpz_setbit(word.get_mpz_t(), limb_bits);
+            math::Inverse_Modulo(inverse, modulo, word);
+            inverse = word - inverse;
+        }
+
+        add(name, Kind::Group, { modulo, generator, R2, inverse });
+    }
+
+    void
+    add_curve(const std::string&                     name,
+              const mpz_class&                       modulo,
+              const mpz_class&                       a,
+              const mpz_class&                       b,
+              const std::pair<mpz_class, mpz_class>& generator,
+              const mpz_class&                       order)
+    {
+        add(name, Kind::Curve, { modulo, a, b, generator.first, generator.second, order });
+    }
+
+    // Store the whole table, so loading it skips the precomputation.
+    void
+    add_fixed_base(const std::string& name, const math::FixedBasePow& table)
+    {
+        std::vector<mpz_class> numbers;
+        numbers.reserve(4 + table.table().size());
+        numbers.emplace_back(table.modulo());
+        numbers.emplace_back(table.base());
+        numbers.emplace_back(static_cast<unsigned long>(table.exponent_bits()));
+        numbers.emplace_back(static_cast<unsigned long>(table.window()));
+        numbers.insert(numbers.end(), table.table().begin(), table.table().end());
+
+        add(name, Kind::Fixed_Base_Table, std::move(numbers));
+    }
+
+    bool
+    write(const std::string& path) const
+    {
+        // Lay everything out first so the file can be created at its final size.
+        std::size_t numbers = 0;
+        std::size_t limbs = 0;
+        for (const auto& entry : entries_)
+        {
+            numbers += entry.second.second.size();
+            for (const auto& number : entry.second.second)
+            {
+                limbs += mpz_size(number.get_mpz_t());
+            }
+        }
+
+        const std::size_t directory_offset = sizeof(Header);
+        const std::size_t table_offset     = directory_offset + entries_.size() * sizeof(Directory_Record);
+        const std::size_t limb_offset      = table_offset + numbers * sizeof(Number_Record);
+        const std::size_t file_size        = limb_offset + limbs * sizeof(mp_limb_t);
+
+        auto out = file::MappedFile::create(path, file_size);
+        if (!out.is_open())
+        {
+            return false;
+        }
+
+        Header header{};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version    = Version;
+        header.limb_bytes = sizeof(mp_limb_t);
+        header.byte_order = Byte_Order;
+        header.entries    = entries_.size();
+        header.file_size  = file_size;
+        std::memcpy(out.data(), &header, sizeof(header));
+
+        // std::map keeps the directory sorted by name.
+        std::size_t directory_position = directory_offset;
+        std::size_t table_position     = table_offset;
+        std::size_t limb_position      = limb_offset;
+        for (const auto& entry : entries_)
+        {
+            Directory_Record record{};
+            std::memcpy(record.name, entry.first.data(), entry.first.size());
+            record.kind         = static_cast<std::uint32_t>(entry.second.first);
+            record.count        = static_cast<std::uint32_t>(entry.second.second.size());
+            record.table_offset = table_position;
+            std::memcpy(out.data() + directory_position, &record, sizeof(record));
+            directory_position += sizeof(record);
+
+            for (const auto& number : entry.second.second)
+            {
+                const std::size_t size = mpz_size(number.get_mpz_t());
+
+                Number_Record number_record{};
+                number_record.limb_offset = limb_position;
+                number_record.size = mpz_sgn(number.get_mpz_t()) < 0
+                                   ? -static_cast<std::int64_t>(size)
+                                   : static_cast<std::int64_t>(size);
+                std::memcpy(out.data() + table_position, &number_record, sizeof(number_record));
+                table_position += sizeof(number_record);
+
+                if (size > 0)
+                {
+                    std::memcpy(out.data() + limb_position,
+                                mpz_limbs_read(number.get_mpz_t()),
+                                size * sizeof(mp_limb_t));
+                }
+                limb_position += size * sizeof(mp_limb_t);
+            }
+        }
+
+        return out.sync();
+    }
+
+private:
+    std::map<std::string, std::pair<Kind, std::vector<mpz_class>>> entries_;
+};
+
+//! @description: Read-only mpz over limbs in the keystore mapping.
+//!               Valid for as long as the Keystore is open. Use it with the mpz_* functions
+//!               that take an mpz_srcptr.
+struct Number_View
+{
+    mpz_t value;
+
+    mpz_srcptr get() const { return value; }
+};
+
+//! @description: An opened keystore. Opening only maps the file and checks its header.
+class Keystore
+{
+public:
+    class Entry
+    {
+    public:
+        Entry() = default;
+
+        Kind        kind()  const { return static_cast<Kind>(record_->kind); }
+        std::size_t count() const { return record_->count; }
+
+        // No copy, no allocation.
+        Number_View
+        view(const std::size_t i) const
+        {
+            const auto number = table(i);
+            Number_View view{};
+            mpz_roinit_n(view.value,
+                         reinterpret_cast<const mp_limb_t*>(base_ + number.limb_offset),
+                         static_cast<mp_size_t>(number.size));
+            return view;
+        }
+
+        // Copies the limbs into a new number.
+        mpz_class
+        get(const std::size_t i) const
+        {
+            return mpz_class(view(i).get());
+        }
+
+    private:
+        friend class Keystore;
+
+        Number_Record
+        table(const std::size_t i) const
+        {
+            assert(i < count());
+            Number_Record number{};
+            std::memcpy(&number, base_ + record_->table_offset + i * sizeof(Number_Record), sizeof(number));
+            return number;
+        }
+
+        const std::uint8_t*     base_   = nullptr;
+        const Directory_Record* record_ = nullptr;
+    };
+
+    Keystore() = default;
+
+    // Returns a closed keystore (and prints why) if the file is missing or not valid here.
+    static Keystore
+    open(const std::string& path)
+    {
+        Keystore store{};
+        store.file_ = file::MappedFile::open_read(path);
+        if (!store.file_.is_open())
+        {
+            return Keystore{};
+        }
+
+        if (!store.validate())
+        {
+            std::cerr << "Not a valid keystore for this machine: " << path << std::endl;
+            return Keystore{};
+        }
+
+        return store;
+    }
+
+    bool is_open() const { return file_.is_open(); }
+
+    std::size_t size() const { return is_open() ? header().entries : 0; }
+
+    // Binary search over the sorted directory.
+    bool
+    find(const std::string& name, Entry& entry) const
+    {
+        if (!is_open() || name.size() >= Name_Length)
+        {
+            return false;
+        }
+
+        char key[Name_Length] = {};
+        std::memcpy(key, name.data(), name.size());
+
+        const auto* first = directory();
+        const auto* last  = first + size();
+        const auto* found = std::lower_bound(first, last, key, [](const Directory_Record& record, const char* k)
+        {
+            return std::memcmp(record.name, k, Name_Length) < 0;
+        });
+
+        if (found == last || std::memcmp(found->name, key, Name_Length) != 0)
+        {
+            return false;
+        }
+
+        entry.base_   = file_.data();
+        entry.record_ = found;
+        return true;
+    }
+
+    bool
+    rsa_key(const std::string& name, RSA_Key& key) const
+    {
+        Entry entry{};
+        if (!find(name, entry) || entry.kind() != Kind::RSA_Key || entry.count() != 8)
+        {
+            return false;
+        }
+
+        key.n    = entry.get(0);
+        key.e    = entry.get(1);
+        key.d    = entry.get(2);
+        key.p    = entry.get(3);
+        key.q    = entry.get(4);
+        key.dP   = entry.get(5);
+        key.dQ   = entry.get(6);
+        key.qInv = entry.get(7);
+        return true;
+    }
+
+    bool
+    group(const std::string& name, Group& group) const
+    {
+        Entry entry{};
+        if (!find(name, entry) || entry.kind() != Kind::Group || entry.count() != 4)
+        {
+            return false;
+        }
+
+        group.modulo             = entry.get(0);
+        group.generator          = entry.get(1);
+        group.montgomery_R2      = entry.get(2);
+        group.montgomery_inverse = entry.get(3);
+        return true;
+    }
+
+    // Montgomery context for a group's modulo, built from the stored constants so R^2 mod modulo
+    // isn't computed again. false for groups with an even modulo.
+    bool
+    montgomery(const std::string& name, math::MontgomeryContext& context) const
+    {
+        Group stored{};
+        return group(name, stored) &&
+               context.load(stored.modulo, stored.montgomery_R2, stored.montgomery_inverse);
+    }
+
+    bool
+    curve(const std::string& name, Curve& curve) const
+    {
+        Entry entry{};
+        if (!find(name, entry) || entry.kind() != Kind::Curve || entry.count() != 6)
+        {
+            return false;
+        }
+
+        curve.modulo           = entry.get(0);
+        curve.a                = entry.get(1);
+        curve.b                = entry.get(2);
+        curve.generator.first  = entry.get(3);
+        curve.generator.second = entry.get(4);
+        curve.order            = entry.get(5);
+        return true;
+    }
+
+    bool
+    fixed_base(const std::string& name, math::FixedBasePow& table) const
+    {
+        Entry entry{};
+        if (!find(name, entry) || entry.kind() != Kind::Fixed_Base_Table || entry.count() < 4)
+        {
+            return false;
+        }
+
+        std::vector<mpz_class> entries;
+        entries.reserve(entry.count() - 4);
+        for (std::size_t i = 4; i < entry.count(); ++i)
+        {
+            entries.emplace_back(entry.get(i));
+        }
+
+        return table.load(entry.get(1),
+                          entry.get(0),
+                          entry.get(2).get_ui(),
+                          entry.get(3).get_ui(),
+                          std::move(entries));
+    }
+
+private:
+    const Header& header() const
+    {
+        return *reinterpret_cast<const Header*>(file_.data());
+    }
+
+    const Directory_Record* directory() const
+    {
+        return reinterpret_cast<const Directory_Record*>(file_.data() + sizeof(Header));
+    }
+
+    // Check everything once, so lookups don't have to.
+    bool
+    validate() const
+    {
+        const std::size_t size = file_.size();
+        if (size < sizeof(Header))
+        {
+            return false;
+        }
+
+        const Header& h = header();
+        if (std::memcmp(h.magic, Magic, sizeof(Magic)) != 0 ||
+            h.version != Version ||
+            h.limb_bytes != sizeof(mp_limb_t) ||
+            h.byte_order != Byte_Order ||
+            h.file_size != size ||
+            h.entries > (size - sizeof(Header)) / sizeof(Directory_Record))
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < h.entries; ++i)
+        {
+            const Directory_Record& record = directory()[i];
+            if (record.name[Name_Length - 1] != '\0' ||
+                record.table_offset % 8 != 0 ||
+                record.table_offset > size ||
+                record.count > (size - record.table_offset) / sizeof(Number_Record))
+            {
+                return false;
+            }
+
+            for (std::size_t j = 0; j < record.count; ++j)
+            {
+                Number_Record number{};
+                std::memcpy(&number, file_.data() + record.table_offset + j * sizeof(Number_Record), sizeof(number));
+                const std::uint64_t limbs = static_cast<std::uint64_t>(number.size < 0 ? -number.size : number.size);
+                if (number.limb_offset % sizeof(mp_limb_t) != 0 ||
+                    number.limb_offset > size ||
+                    limbs > (size - number.limb_offset) / sizeof(mp_limb_t))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    file::MappedFile file_;
+};
+
+} // namespace keystore
+} // namespace crypto
+#endif // KEYSTORE_UTILS_HPP
@@ -2,55 +2,116 @@
 #define MESSAGE_UTILS_HPP
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <limits>
-#include <map>
 #include <math.h>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+// SIMD
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "Math_utils.hpp"
 
 namespace message
 {
-static const std::map<char, std::size_t> numeric_plaintext_map_basic = {
-    { 'a', 1 },  { 'b', 2  }, { 'c', 3 },  { 'd', 4  }, 
-    { 'e', 5 },  { 'f', 6  }, { 'g', 7 },  { 'h', 8  }, 
-    { 'i', 9 },  { 'j', 10 }, { 'k', 11 }, { 'l', 12 }, 
-    { 'm', 13 }, { 'n', 14 }, { 'o', 15 }, { 'p', 16 }, 
-    { 'q', 17 }, { 'r', 18 }, { 's', 19 }, { 't', 20 }, 
-    { 'u', 21 }, { 'v', 22 }, { 'w', 23 }, { 'x', 24 },
-    { 'y', 25 }, { 'z', 26 }, { ' ', 27 }, { '\0',  0 }
-};
+// Marks a character that is not part of the plaintext alphabet.
+static constexpr std::uint8_t unmapped_numeric = 0xFF;
 
-static const std::map<char, int64_t> numeric_plaintext_map_ascii = {
-    { 'a', int('a') }, { 'b', int('b') }, { 'c', int('c') }, { 'd', int('d') },
-    { 'e', int('e') }, { 'f', int('f') }, { 'g', int('g') }, { 'h', int('h') },
-    { 'i', int('i') }, { 'j', int('j') }, { 'k', int('k') }, { 'l', int('l') },
-    { 'm', int('m') }, { 'n', int('n') }, { 'o', int('o') }, { 'p', int('p') },
-    { 'q', int('q') }, { 'r', int('r') }, { 's', int('s') }, { 't', int('t') },
-    { 'u', int('u') }, { 'v', int('v') }, { 'w', int('w') }, { 'x', int('x') },
-    { 'y', int('y') }, { 'z', int('z') }, { ' ', int(' ')},
-
-    { 'A', int('A') }, { 'B', int('B') }, { 'C', int('C') }, { 'D', int('D') }, 
-    { 'E', int('E') }, { 'F', int('F') }, { 'G', int('G') }, { 'H', int('H') }, 
-    { 'I', int('I') }, { 'J', int('J') }, { 'K', int('K') }, { 'L', int('L') }, 
-    { 'M', int('M') }, { 'N', int('N') }, { 'O', int('O') }, { 'P', int('P') }, 
-    { 'Q', int('Q') }, { 'R', int('R') }, { 'S', int('S') }, { 'T', int('T') }, 
-    { 'U', int('U') }, { 'V', int('V') }, { 'W', int('W') }, { 'X', int('X') },
-    { 'Y', int('Y') }, { 'Z', int('Z') }
-};
+// The lookup tables are built at compile time, so nothing is constructed at startup.
+// Forward tables are indexed by the unsigned value of the character.
+// Reverse tables are indexed by the numeric value.
+
+// a-z = 1-26, space = 27, '\0' = 0. Upper case letters fold to lower case.
+static constexpr std::array<std::uint8_t, 256>
+make_numeric_plaintext_table_basic()
+{
+    std::array<std::uint8_t, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        table[i] = unmapped_numeric;
+    }
+
+    for (std::size_t i = 0; i < 26; ++i)
+    {
+        table['a' + i] = static_cast<std::uint8_t>(i + 1);
+        table['A' + i] = static_cast<std::uint8_t>(i + 1);
+    }
+    table[' ']  = 27;
+    table['\0'] = 0;
+
+    return table;
+}
+
+static constexpr std::array<char, 256>
+make_plaintext_char_table_basic()
+{
+    std::array<char, 256> table{};
+    for (std::size_t i = 0; i < 26; ++i)
+    {
+        table[i + 1] = static_cast<char>('a' + i);
+    }
+    table[27] = ' ';
+
+    return table;
+}
+
+// Letters and space map to their ASCII codes.
+static constexpr std::array<std::uint8_t, 256>
+make_numeric_plaintext_table_ascii()
+{
+    std::array<std::uint8_t, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        table[i] = unmapped_numeric;
+    }
+
+    for (std::size_t i = 0; i < 26; ++i)
+    {
+        table['a' + i] = static_cast<std::uint8_t>('a' + i);
+        table['A' + i] = static_cast<std::uint8_t>('A' + i);
+    }
+    table[' '] = static_cast<std::uint8_t>(' ');
+
+    return table;
+}
+
+static constexpr std::array<char, 256>
+make_plaintext_char_table_ascii()
+{
+    std::array<char, 256> table{};
+    for (std::size_t i = 0; i < 26; ++i)
+    {
+        table['a' + i] = static_cast<char>('a' + i);
+        table['A' + i] = static_cast<char>('A' + i);
+    }
+    table[' '] = ' ';
+
+    return table;
+}
+
+static constexpr auto numeric_plaintext_table_basic = make_numeric_plaintext_table_basic();
+static constexpr auto plaintext_char_table_basic    = make_plaintext_char_table_basic();
+static constexpr auto numeric_plaintext_table_ascii = make_numeric_plaintext_table_ascii();
+static constexpr auto plaintext_char_table_ascii    = make_plaintext_char_table_ascii();
 
 
 // Custom map
-#define numeric_plaintext_map numeric_plaintext_map_basic
-#define SIZE_numeric_plaintext numeric_plaintext_map_basic.size()
+#define numeric_plaintext_table numeric_plaintext_table_basic
+#define plaintext_char_table plaintext_char_table_basic
+#define SIZE_numeric_plaintext std::size_t(28)
 
 //! @thought: It seems we can reduce the map NJIT by making the size smaller
 // ASCII
 // #define using_ASCII // Helper flag.
-// #define numeric_plaintext_map numeric_plaintext_map_ascii
+// #define numeric_plaintext_table numeric_plaintext_table_ascii
+// #define plaintext_char_table plaintext_char_table_ascii
 // #define SIZE_numeric_plaintext std::size_t(126) // ASCII
 
 
@@ -89,47 +150,359 @@ static const std::map<char, int64_t> numeric_plaintext_map_ascii = {
 static inline std::size_t 
 char_to_numeric(const char& charac)
 {
-    std::size_t numeric = std::numeric_limits<std::size_t>::max();
+    const auto numeric = numeric_plaintext_table[static_cast<unsigned char>(charac)];
+    if (numeric == unmapped_numeric)
+    {
+        return std::numeric_limits<std::size_t>::max();
+    }
+
+    return numeric;
+}
+
+template<typename T>
+static inline char
+numeric_to_char(const T num)
+{
+    if constexpr (std::is_integral<T>::value)
+    {
+        // Negative values wrap around and are rejected as well.
+        if (static_cast<std::uint64_t>(num) >= SIZE_numeric_plaintext)
+        {
+            return char{};
+        }
+        return plaintext_char_table[static_cast<std::size_t>(num)];
+    }
+    else
+    {
+        // mpz_class or a GMP expression.
+        const mpz_class value(num);
+        if (value < 0 || value >= SIZE_numeric_plaintext)
+        {
+            return char{};
+        }
+        return plaintext_char_table[value.get_ui()];
+    }
+}
+
+//! @description: Convert a whole run of characters to numerics at once.
+//!               Characters outside the alphabet become unmapped_numeric.
+//! @params: text:    characters to convert
+//!          length:  number of characters
+//!          numeric: output buffer with room for length entries
+static inline void
+text_to_numeric(const char*   text,
+                std::size_t   length,
+                std::uint8_t* numeric)
+{
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    // 16 characters per iteration. Everything is a range check, so no table lookup is needed.
+    // Bytes >= 0x80 are negative as signed bytes and fail the letter range check.
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i before_a = _mm_set1_epi8('a' - 1);
+    const __m128i after_z  = _mm_set1_epi8('z' + 1);
+    const __m128i space    = _mm_set1_epi8(' ');
+    const __m128i unmapped = _mm_set1_epi8(static_cast<char>(unmapped_numeric));
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i chars  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        const __m128i lower  = _mm_or_si128(chars, case_bit);
+        const __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+                                             _mm_cmpgt_epi8(after_z, lower));
+        const __m128i is_space = _mm_cmpeq_epi8(chars, space);
+        const __m128i mapped   = _mm_or_si128(letter, is_space);
 
 #ifndef using_ASCII
-    const auto it = numeric_plaintext_map.find(std::tolower(charac));
+        // a-z = 1-26, space = 27, '\0' = 0.
+        const __m128i is_null = _mm_cmpeq_epi8(chars, _mm_setzero_si128());
+        __m128i result = _mm_and_si128(letter, _mm_sub_epi8(lower, before_a));
+        result = _mm_or_si128(result, _mm_and_si128(is_space, _mm_set1_epi8(27)));
+        result = _mm_or_si128(result, _mm_andnot_si128(_mm_or_si128(mapped, is_null), unmapped));
 #else
-    const auto it = numeric_plaintext_map.find(charac);
+        // Mapped characters keep their own code.
+        __m128i result = _mm_and_si128(mapped, chars);
+        result = _mm_or_si128(result, _mm_andnot_si128(mapped, unmapped));
 #endif
-    if (it != numeric_plaintext_map.cend())
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(numeric + i), result);
+    }
+#endif
+
+    for (; i < length; ++i)
     {
-        // std::cout << "Character for " << charac << ", is " << it->second << std::endl;
-        numeric = it->second;
+        numeric[i] = numeric_plaintext_table[static_cast<unsigned char>(text[i])];
     }
-    // else
-    // {
-    //     std::cout << "Ignoring character: " << charac << std::endl;
-    // }
+}
 
+static inline std::vector<std::uint8_t>
+text_to_numeric(const std::string& text)
+{
+    std::vector<std::uint8_t> numeric(text.size());
+    text_to_numeric(text.data(), text.size(), numeric.data());
     return numeric;
 }
 
-template<typename T>
-static inline char
-numeric_to_char(const T num)
+//! @description: Convert a whole run of numerics back to characters.
+//!               Numerics outside the alphabet become '\0'.
+static inline void
+numeric_to_text(const std::uint8_t* numeric,
+                std::size_t         length,
+                char*               text)
+{
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        text[i] = plaintext_char_table[numeric[i]];
+    }
+}
+
+// Largest number of digits in the given base whose value always fits in a 64-bit word.
+static constexpr std::size_t
+radix_word_digits(const std::size_t base)
+{
+    std::size_t digits = 0;
+    std::uint64_t limit = std::numeric_limits<std::uint64_t>::max();
+    while (limit >= base)
+    {
+        limit /= base;
+        ++digits;
+    }
+    return digits;
+}
+
+//! @description: Powers base^(leaf * 2^k) used to split numbers in half for radix conversion.
+//!               Build it once and reuse it for every block of a message.
+class RadixPowers
+{
+public:
+    explicit RadixPowers(const std::size_t base = SIZE_numeric_plaintext)
+        : base_(base),
+          leaf_digits_(radix_word_digits(base))
+    {
+        assert(base_ >= 2);
+    }
+
+    std::size_t base() const { return base_; }
+
+    // Number of digits handled in a machine word at the bottom of the recursion.
+    std::size_t leaf_digits() const { return leaf_digits_; }
+
+    // base^(leaf_digits * 2^k)
+    const mpz_class& operator[](const std::size_t k) const { return powers_[k]; }
+
+    // Make sure numbers with up to `digits` digits can be split down to the leaves.
+    void reserve(const std::size_t digits)
+    {
+        if (powers_.empty())
+        {
+            mpz_class first{};
+            mpz_ui_pow_ui(first.get_mpz_t(), base_, leaf_digits_);
+            powers_.emplace_back(first);
+        }
+
+        // Square the previous power until it covers half of the digits.
+        while ((leaf_digits_ << powers_.size()) < digits)
+        {
+            powers_.emplace_back(powers_.back() * powers_.back());
+        }
+    }
+
+    // Largest k such that leaf_digits * 2^k < digits. Requires digits > leaf_digits.
+    std::size_t split_level(const std::size_t digits) const
+    {
+        std::size_t k = 0;
+        while ((leaf_digits_ << (k + 1)) < digits)
+        {
+            ++k;
+        }
+        assert(k < powers_.size());
+        return k;
+    }
+
+private:
+    std::size_t            base_;
+    std::size_t            leaf_digits_;
+    std::vector<mpz_class> powers_;
+};
+
+//! @description: Combine digits (most significant first) into a single number.
+//!               Divide and conquer: value = high * base^m + low, so the big multiplications
+//!               are balanced and GMP can use its subquadratic algorithms.
+//! @params: digits may be std::uint8_t (fast word leaves) or mpz_class (any digit value).
+template<typename Digit>
+static inline void
+digits_to_integer(mpz_class&         result,
+                  const Digit*       digits,
+                  const std::size_t  length,
+                  const RadixPowers& powers)
+{
+    if (length <= powers.leaf_digits())
+    {
+        if constexpr (std::is_same<Digit, std::uint8_t>::value)
+        {
+            std::uint64_t word = 0;
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                word = word * powers.base() + digits[i];
+            }
+            mpz_set_ui(result.get_mpz_t(), word);
+        }
+        else
+        {
+            result = 0;
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                result *= powers.base();
+                result += digits[i];
+            }
+        }
+        return;
+    }
+
+    const std::size_t k = powers.split_level(length);
+    const std::size_t m = powers.leaf_digits() << k;
+
+    mpz_class high{};
+    digits_to_integer(high, digits, length - m, powers);
+    digits_to_integer(result, digits + length - m, m, powers);
+    mpz_addmul(result.get_mpz_t(), high.get_mpz_t(), powers[k].get_mpz_t());
+}
+
+//! @description: Split a number into exactly `length` digits (most significant first).
+//!               The number must be smaller than base^length. Leading digits are zero.
+static inline void
+integer_to_digits(const mpz_class&   value,
+                  const std::size_t  length,
+                  std::uint8_t*      digits,
+                  const RadixPowers& powers)
+{
+    if (length <= powers.leaf_digits())
+    {
+        std::uint64_t word = value.get_ui();
+        for (std::size_t i = length; i > 0; --i)
+        {
+            digits[i - 1] = static_cast<std::uint8_t>(word % powers.base());
+            word /= powers.base();
+        }
+        return;
+    }
+
+    const std::size_t k = powers.split_level(length);
+    const std::size_t m = powers.leaf_digits() << k;
+
+    mpz_class high{};
+    mpz_class low{};
+    mpz_tdiv_qr(high.get_mpz_t(), low.get_mpz_t(), value.get_mpz_t(), powers[k].get_mpz_t());
+    integer_to_digits(high, length - m, digits, powers);
+    integer_to_digits(low, m, digits + length - m, powers);
+}
+
+// Upper bound on the number of digits of a number. Always at least 1.
+static inline std::size_t
+integer_digits_bound(const mpz_class& value, const std::size_t base)
 {
-    char c{};
-    for (const auto& e : numeric_plaintext_map)
+    const double bits = static_cast<double>(mpz_sizeinbase(value.get_mpz_t(), 2));
+    return static_cast<std::size_t>(bits / std::log2(static_cast<double>(base))) + 2;
+}
+
+// Decode one number into characters, starting at text. Returns the number of characters written.
+// Leading zero digits are dropped, but a value of 0 is still one character.
+static inline std::size_t
+decode_naive_block(const mpz_class&           value,
+                   const RadixPowers&         powers,
+                   std::vector<std::uint8_t>& scratch,
+                   char*                      text)
+{
+    const auto bound = integer_digits_bound(value, powers.base());
+    scratch.resize(bound);
+    integer_to_digits(value, bound, scratch.data(), powers);
+
+    std::size_t first = 0;
+    while (first + 1 < bound && scratch[first] == 0)
     {
-        if (e.second == num)
+        ++first;
+    }
+
+    numeric_to_text(scratch.data() + first, bound - first, text);
+    return bound - first;
+}
+
+// Encode one block of numerics. Takes the word-sized path when every digit is a real numeric.
+static inline mpz_class
+encode_naive_block(const mpz_class*           block,
+                   const std::size_t          length,
+                   const RadixPowers&         powers,
+                   std::vector<std::uint8_t>& scratch)
+{
+    mpz_class compressed{};
+
+    scratch.resize(length);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        if (!mpz_fits_ulong_p(block[i].get_mpz_t()) || block[i].get_ui() >= powers.base())
         {
-            // std::cout << "Character for " << num << ", is " << e.first << std::endl;
-            c = e.first;
-            break;
+            // Unmapped characters are carried through as-is, same as before.
+            digits_to_integer(compressed, block, length, powers);
+            return compressed;
         }
-        // else
-        // {
-        //     std::cout << "Did not find character for " << num << std::endl;
-        // }
+        scratch[i] = static_cast<std::uint8_t>(block[i].get_ui());
+    }
+
+    digits_to_integer(compressed, scratch.data(), length, powers);
+    return compressed;
+}
 
+// Largest number of characters per block whose compressed value is always below modulo.
+static inline std::size_t
+max_block_size(const mpz_class& modulo)
+{
+    std::size_t block_size = 0;
+    mpz_class power(SIZE_numeric_plaintext);
+    while (power <= modulo)
+    {
+        ++block_size;
+        power *= SIZE_numeric_plaintext;
     }
+    return block_size;
+}
+
+// Raw bytes are the 256 character alphabet. Every byte value is a digit, so any data round trips.
+// Blocks are big endian: the first byte is the most significant digit.
+
+// Largest number of bytes per block whose value is always below modulo.
+static inline std::size_t
+max_byte_block_size(const mpz_class& modulo)
+{
+    return (mpz_sizeinbase(modulo.get_mpz_t(), 2) - 1) / 8;
+}
+
+// Number of bytes that can hold any value below modulo.
+static inline std::size_t
+byte_width(const mpz_class& modulo)
+{
+    return (mpz_sizeinbase(modulo.get_mpz_t(), 2) + 7) / 8;
+}
 
-    return c;
+static inline void
+bytes_to_integer(mpz_class&          result,
+                 const std::uint8_t* bytes,
+                 const std::size_t   length)
+{
+    mpz_import(result.get_mpz_t(), length, 1, 1, 1, 0, bytes);
+}
+
+// Write exactly `width` bytes, zero filled on the left. The value must fit.
+static inline void
+integer_to_bytes(const mpz_class&  value,
+                 std::uint8_t*     bytes,
+                 const std::size_t width)
+{
+    const std::size_t length = value == 0 ? 0 : (mpz_sizeinbase(value.get_mpz_t(), 2) + 7) / 8;
+    assert(length <= width);
+
+    std::fill(bytes, bytes + width - length, 0);
+
+    std::size_t count = 0;
+    mpz_export(bytes + width - length, &count, 1, 1, 1, 0, value.get_mpz_t());
 }
 
 static inline std::vector<std::vector<mpz_class>>
@@ -138,27 +511,28 @@ naive_plaintext_numeric(const std::string& plaintext, std::size_t block_size)
     assert(block_size > 0);
 
     std::vector<std::vector<mpz_class>> all_blocks;
-    all_blocks.reserve(std::ceil(plaintext.size() / block_size));
+    all_blocks.reserve((plaintext.size() + block_size - 1) / block_size);
+
+    // Convert the whole string in one pass.
+    const auto numeric = text_to_numeric(plaintext);
 
     std::vector<mpz_class> block;
     block.reserve(block_size);
 
-    // i = index of string
-    // b = keep track of block
-    for (std::size_t i = 0, b = 0; i < plaintext.size(); ++i, ++b)
+    for (const auto num : numeric)
     {
-        // Get numeric.
-        auto num = char_to_numeric(plaintext[i]);
-        block.emplace_back(num);
-        // std::cout << "placing into block: " << plaintext[i] << std::endl;
-        // Reached our block limit.
-        if (b >= block_size - 1)
+        if (num == unmapped_numeric)
+        {
+            block.emplace_back(std::numeric_limits<std::size_t>::max());
+        }
+        else
         {
-            // std::cout << "reached block limit" << std::endl;
-            // Reset block counter to -1 because we are incrementing b after this.
-            b = -1;
+            block.emplace_back(static_cast<unsigned long>(num));
+        }
 
-            // std::cout << "clearing out block after adding character: " << plaintext[i] << std::endl;
+        // Reached our block limit.
+        if (block.size() == block_size)
+        {
             all_blocks.emplace_back(block);
             block.clear();
         }
@@ -185,12 +559,18 @@ static inline std::vector<mpz_class>
 naive_plaintext_numeric(const std::string& str)
 {
     std::vector<mpz_class> numeric_form;
-    numeric_form.reserve(str.size() * 2);
+    numeric_form.reserve(str.size());
 
-    for (const auto& c : str)
+    for (const auto num : text_to_numeric(str))
     {
-        auto val = char_to_numeric(c);
-        numeric_form.emplace_back(val);            
+        if (num == unmapped_numeric)
+        {
+            numeric_form.emplace_back(std::numeric_limits<std::size_t>::max());
+        }
+        else
+        {
+            numeric_form.emplace_back(static_cast<unsigned long>(num));
+        }
     }
 
     return numeric_form;
@@ -201,42 +581,25 @@ encode_naive_representation(const std::vector<std::vector<mpz_class>>& all_block
 {
     std::vector<mpz_class> all_blocks_compressed;
     all_blocks_compressed.reserve(all_blocks.size());
-    // std::cout << all_blocks.size() << std::endl;
+
+    // One power table for every block.
+    RadixPowers powers{};
+    std::vector<std::uint8_t> scratch;
     for (const auto& block : all_blocks)
     {
-        mpz_class compressed_block{};
-        // std::cout << "current block: ";
-        std::size_t actual_block_size = block.size() - 1;
+        std::size_t actual_block_size = block.size();
 
-        // Get an r value in case we zero padded, and r would be larger than it actually should be.
-        if (block.back() == 0)
+        // Don't count the zero padding, so the value is the same as for an unpadded block.
+        if (!block.empty() && block.back() == 0)
         {
-            for (std::size_t i = 0; i <= block.size() - 1; ++i)
-            {
-                if (block[i] == 0)
-                {
-                    // Need to go down because we don't want to include this character.
-                    actual_block_size = i - 1;
-                    // std::cout << "actual_block_size = " << actual_block_size << std::endl;
-                    break;
-                }
-            }
+            actual_block_size = std::find(block.cbegin(), block.cend(), 0) - block.cbegin();
         }
-        for (std::size_t i = 0, r = actual_block_size;
-            i <= actual_block_size; 
-            ++i, --r)
-        {
-            // std::cout << block[i] << "\t";
-            // r would be very large if we have a 0, so skip it.
 
-            mpz_class result = block[i] * math::IPow(SIZE_numeric_plaintext, r);
-            // std::cout << block[i] << "\t*\t" << SIZE_numeric_plaintext << "^" << r << std::endl;
-            // std::cout << "result = " << result << "\t";
-            compressed_block += result;
-        }
-        // std::cout << std::endl;
-        // Push compressed version to new vector.
-        all_blocks_compressed.emplace_back(compressed_block);
+        powers.reserve(actual_block_size);
+        all_blocks_compressed.emplace_back(encode_naive_block(block.data(),
+                                                              actual_block_size,
+                                                              powers,
+                                                              scratch));
     }
 
     return all_blocks_compressed;
@@ -246,77 +609,49 @@ encode_naive_representation(const std::vector<std::vector<mpz_class>>& all_block
 static inline mpz_class
 encode_naive_representation(const std::vector<mpz_class>& numeric_form)
 {
-    mpz_class compressed_num{};
-    for (std::size_t i = 0, r = numeric_form.size() - 1;
-         i <= numeric_form.size() - 1; 
-         ++i, --r)
-    {
-        mpz_class result = numeric_form[i] * math::IPow(SIZE_numeric_plaintext, r);
-        compressed_num += result;
-    }
+    RadixPowers powers{};
+    powers.reserve(numeric_form.size());
 
-    return compressed_num;
+    std::vector<std::uint8_t> scratch;
+    return encode_naive_block(numeric_form.data(), numeric_form.size(), powers, scratch);
 }
 
 static inline std::string 
-decode_naive_representation(std::vector<mpz_class>& all_blocks_compressed)
+decode_naive_representation(const std::vector<mpz_class>& all_blocks_compressed)
 {
-    std::string text = "";
+    RadixPowers powers{};
 
-    // Starting from bottom up will always get the same order of characters 
-    // regardless of block size.
-    for (auto rit_block = all_blocks_compressed.crbegin();
-         rit_block != all_blocks_compressed.crend();
-         ++rit_block)
+    // Size the output for the largest possible message and trim at the end.
+    std::size_t bound = 0;
+    for (const auto& block : all_blocks_compressed)
     {
-        auto block_value = *rit_block;
-        // When we have more than 1 character per block.
-        while (block_value > SIZE_numeric_plaintext)
-        {
-            mpz_class num{};
-            mpz_powm_ui(num.get_mpz_t(),
-                        block_value.get_mpz_t(),   // Base
-                        1, // Exponent is 1
-                        mpz_class(SIZE_numeric_plaintext).get_mpz_t());
-
-            text.insert(0, 1, numeric_to_char(num));
-            block_value = (block_value - num) / SIZE_numeric_plaintext;
-        }
+        const auto digits = integer_digits_bound(block, powers.base());
+        powers.reserve(digits);
+        bound += digits;
+    }
 
-        // Either we have 1 character per block or we're on the last character.
-        if (block_value < SIZE_numeric_plaintext)
-        {
-            // std::cout << "less, block_compressed = " << block_value << std::endl;
-            // Most likely last letter.
-            text.insert(0, 1, numeric_to_char(block_value));
-            // std::cout << "text = " << text << std::endl;
-            // std::cout << std::endl;
-        }
+    std::string text(bound, '\0');
+    std::vector<std::uint8_t> scratch;
+
+    // Blocks are stored in message order, the most significant digit first.
+    std::size_t length = 0;
+    for (const auto& block : all_blocks_compressed)
+    {
+        length += decode_naive_block(block, powers, scratch, &text[length]);
     }
+    text.resize(length);
+
     return text;
 }
 
 // Deprecated. no block size.
 static inline std::string 
-decode_naive_representation(mpz_class compressed_num)
+decode_naive_representation(const mpz_class& compressed_num)
 {
-    std::string text = "";
-    for (;;)
-    {
-        if (compressed_num < SIZE_numeric_plaintext)
-        {
-            // Most likely last letter.
-            text.insert(0, 1, numeric_to_char(compressed_num));
-            break;
-        }
-        auto num = compressed_num % SIZE_numeric_plaintext;
-        text.insert(0, 1, numeric_to_char(num));
-        compressed_num = (compressed_num - num) / SIZE_numeric_plaintext;
-    }
-
-    return text;
+    return decode_naive_representation(std::vector<mpz_class>{ compressed_num });
 }
 } // namespace message
 
-#undef numeric_plaintext_map
+#undef numeric_plaintext_table
+#undef plaintext_char_table
 #endif // MESSAGE_UTILS_HPP
@@ -0,0 +1,88 @@
+#ifndef RANDOM_UTILS_HPP
+#define RANDOM_UTILS_HPP
+
+// Standard C/C++
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+
+// GMP
+#include <gmpxx.h>
+
+namespace crypto
+{
+namespace random
+{
+//! @description: Bytes from the operating system's entropy pool (/dev/urandom), for everything an
+//!               attacker must not be able to predict: ElGamal's k, ZKP commitments and challenges.
+//!               gmp_randclass is a Mersenne Twister and anyone who knows (or guesses) its seed
+//!               can replay it, so it is only for tests and simulations.
+//!               There is no sensible fallback when the pool can't be read, so that aborts.
+static inline void
+bytes(std::uint8_t* out, std::size_t size)
+{
+    static const int fd = ::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "Could not open /dev/urandom" << std::endl;
+        std::abort();
+    }
+
+    while (size > 0)
+    {
+        const ssize_t got = ::read(fd, out, size);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            std::cerr << "Could not read /dev/urandom" << std::endl;
+            std::abort();
+        }
+        out += got;
+        size -= static_cast<std::size_t>(got);
+    }
+}
+
+// Uniform in [0, 2^count).
+static inline mpz_class
+bits(const std::size_t count)
+{
+    std::vector<std::uint8_t> buffer((count + 7) / 8);
+    bytes(buffer.data(), buffer.size());
+    if (count % 8 != 0)
+    {
+        buffer[0] &= static_cast<std::uint8_t>((1u << (count % 8)) - 1);
+    }
+
+    mpz_class value{};
+    mpz_import(value.get_mpz_t(), buffer.size(), 1, 1, 1, 0, buffer.data());
+    return value;
+}
+
+// Uniform in [0, n) for n > 0: draws of n's bit length until one is below n (fewer than two
+// on average).
+static inline mpz_class
+below(const mpz_class& n)
+{
+    assert(n > 0);
+    const std::size_t count = mpz_sizeinbase(n.get_mpz_t(), 2);
+    mpz_class value{};
+    do
+    {
+        value = bits(count);
+    } while (value >= n);
+    return value;
+}
+
+} // namespace random
+} // namespace crypto
+#endif // RANDOM_UTILS_HPP
@@ -0,0 +1,369 @@
+#ifndef SERIAL_UTILS_HPP
+#define SERIAL_UTILS_HPP
+
+// Standard C/C++
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// GMP
+#include <gmpxx.h>
+
+namespace crypto
+{
+namespace serial
+{
+// Binary format for keys, ciphertexts, points and signatures.
+//
+// Every record starts with 2 bytes: format version, record type.
+// It is followed by its fields in a fixed order. A field is either
+//   a word:    unsigned LEB128 varint
+//   a number:  varint (byte length << 1 | sign) followed by the magnitude in big endian bytes
+// Numbers go through mpz_export/mpz_import, so nothing is converted to or from decimal,
+// and a reader can import numbers straight out of the caller's buffer.
+static constexpr std::uint8_t Version = 1;
+
+enum class Type : std::uint8_t
+{
+    RSA_Public_Key      = 1, // {e, n}
+    RSA_Private_Key     = 2, // {d, n}
+    RSA_Ciphertext      = 3, // c
+    ElGamal_Public_Key  = 4, // {key, {generator, modulo}}
+    ElGamal_Ciphertext  = 5, // {{ciphertext, hint}, {modulo, generator}}
+    ElGamal_Signature   = 6, // {{message, K}, {X, Y}}
+    EC_Point            = 7, // {x, y}
+    ZKP_Proof           = 8, // {N, key count, public keys, round count, commitments, responses}
+    EC_Point_Compressed = 9, // {x, y parity}
+};
+
+//! @description: Appends records to a byte vector.
+class Writer
+{
+public:
+    explicit Writer(std::vector<std::uint8_t>& out)
+        : out_(out)
+    {
+    }
+
+    void
+    begin(const Type type)
+    {
+        out_.push_back(Version);
+        out_.push_back(static_cast<std::uint8_t>(type));
+    }
+
+    void
+    word(std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out_.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    void
+    number(const mpz_class& value)
+    {
+        const int sign = mpz_sgn(value.get_mpz_t());
+        const std::size_t length = sign == 0 ? 0 : (mpz_sizeinbase(value.get_mpz_t(), 2) + 7) / 8;
+        word((static_cast<std::uint64_t>(length) << 1) | (sign < 0 ? 1 : 0));
+
+        // Export straight into the output.
+        const std::size_t offset = out_.size();
+        out_.resize(offset + length);
+        if (length > 0)
+        {
+            std::size_t count = 0;
+            mpz_export(out_.data() + offset, &count, 1, 1, 1, 0, value.get_mpz_t());
+        }
+    }
+
+private:
+    std::vector<std::uint8_t>& out_;
+};
+
+//! @description: Reads records from a caller owned buffer without copying it.
+//!               Every read returns false on truncated or malformed input, and the reader stays
+//!               failed from then on.
+class Reader
+{
+public:
+    Reader(const std::uint8_t* data, const std::size_t size)
+        : data_(data),
+          size_(size)
+    {
+    }
+
+    explicit Reader(const std::vector<std::uint8_t>& buffer)
+        : Reader(buffer.data(), buffer.size())
+    {
+    }
+
+    bool ok() const { return ok_; }
+
+    // Bytes consumed so far.
+    std::size_t position() const { return position_; }
+
+    bool at_end() const { return position_ == size_; }
+
+    bool
+    begin(const Type type)
+    {
+        if (!ok_ || size_ - position_ < 2 ||
+            data_[position_] != Version ||
+            data_[position_ + 1] != static_cast<std::uint8_t>(type))
+        {
+            return fail();
+        }
+
+        position_ += 2;
+        return true;
+    }
+
+    bool
+    word(std::uint64_t& value)
+    {
+        value = 0;
+        for (unsigned shift = 0; ok_ && position_ < size_ && shift < 64; shift += 7)
+        {
+            const std::uint8_t byte = data_[position_++];
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    // The magnitude of the next number as a view into the buffer. Nothing is copied.
+    bool
+    number_view(const std::uint8_t*& bytes, std::size_t& length, bool& negative)
+    {
+        std::uint64_t header = 0;
+        if (!word(header))
+        {
+            return false;
+        }
+
+        length   = static_cast<std::size_t>(header >> 1);
+        negative = (header & 1) != 0;
+        if (length > size_ - position_)
+        {
+            return fail();
+        }
+
+        bytes = data_ + position_;
+        position_ += length;
+        return true;
+    }
+
+    // Imports the next number directly from the buffer.
+    bool
+    number(mpz_class& value)
+    {
+        const std::uint8_t* bytes = nullptr;
+        std::size_t length = 0;
+        bool negative = false;
+        if (!number_view(bytes, length, negative))
+        {
+            return false;
+        }
+
+        mpz_import(value.get_mpz_t(), length, 1, 1, 1, 0, bytes);
+        if (negative)
+        {
+            mpz_neg(value.get_mpz_t(), value.get_mpz_t());
+        }
+        return true;
+    }
+
+private:
+    bool
+    fail()
+    {
+        ok_ = false;
+        return false;
+    }
+
+    const std::uint8_t* data_;
+    std::size_t         size_;
+    std::size_t         position_ = 0;
+    bool                ok_ = true;
+};
+
+// RSA public key {e, n}, as returned by RSA_Key_Generation.
+static inline void
+write_rsa_public_key(std::vector<std::uint8_t>& out, const std::pair<mpz_class, mpz_class>& key)
+{
+    Writer writer(out);
+    writer.begin(Type::RSA_Public_Key);
+    writer.number(key.first);
+    writer.number(key.second);
+}
+
+static inline bool
+read_rsa_public_key(Reader& reader, std::pair<mpz_class, mpz_class>& key)
+{
+    return reader.begin(Type::RSA_Public_Key) &&
+           reader.number(key.first) &&
+           reader.number(key.second);
+}
+
+// RSA private key {d, n}.
+static inline void
+write_rsa_private_key(std::vector<std::uint8_t>& out, const mpz_class& d, const mpz_class& n)
+{
+    Writer writer(out);
+    writer.begin(Type::RSA_Private_Key);
+    writer.number(d);
+    writer.number(n);
+}
+
+static inline bool
+read_rsa_private_key(Reader& reader, mpz_class& d, mpz_class& n)
+{
+    return reader.begin(Type::RSA_Private_Key) &&
+           reader.number(d) &&
+           reader.number(n);
+}
+
+static inline void
+write_rsa_ciphertext(std::vector<std::uint8_t>& out, const mpz_class& ciphertext)
+{
+    Writer writer(out);
+    writer.begin(Type::RSA_Ciphertext);
+    writer.number(ciphertext);
+}
+
+static inline bool
+read_rsa_ciphertext(Reader& reader, mpz_class& ciphertext)
+{
+    return reader.begin(Type::RSA_Ciphertext) &&
+           reader.number(ciphertext);
+}
+
+// ElGamal public key {key, {generator, modulo}}, as returned by ElGamal_Key_Generation.
+static inline void
+write_elgamal_public_key(std::vector<std::uint8_t>& out,
+                         const std::pair<mpz_class, std::pair<mpz_class, mpz_class>>& key)
+{
+    Writer writer(out);
+    writer.begin(Type::ElGamal_Public_Key);
+    writer.number(key.first);
+    writer.number(key.second.first);
+    writer.number(key.second.second);
+}
+
+static inline bool
+read_elgamal_public_key(Reader& reader,
+                        std::pair<mpz_class, std::pair<mpz_class, mpz_class>>& key)
+{
+    return reader.begin(Type::ElGamal_Public_Key) &&
+           reader.number(key.first) &&
+           reader.number(key.second.first) &&
+           reader.number(key.second.second);
+}
+
+// ElGamal {{ciphertext, hint}, {modulo, generator}}, as returned by ElGamal_Encrypt.
+static inline void
+write_elgamal_ciphertext(std::vector<std::uint8_t>& out,
+                         const std::pair<std::pair<mpz_class, mpz_class>,
+                                         std::pair<std::uint64_t, std::uint64_t>>& ciphertext)
+{
+    Writer writer(out);
+    writer.begin(Type::ElGamal_Ciphertext);
+    writer.number(ciphertext.first.first);
+    writer.number(ciphertext.first.second);
+    writer.word(ciphertext.second.first);
+    writer.word(ciphertext.second.second);
+}
+
+static inline bool
+read_elgamal_ciphertext(Reader& reader,
+                        std::pair<std::pair<mpz_class, mpz_class>,
+                                  std::pair<std::uint64_t, std::uint64_t>>& ciphertext)
+{
+    return reader.begin(Type::ElGamal_Ciphertext) &&
+           reader.number(ciphertext.first.first) &&
+           reader.number(ciphertext.first.second) &&
+           reader.word(ciphertext.second.first) &&
+           reader.word(ciphertext.second.second);
+}
+
+// ElGamal signature {{message, K}, {X, Y}}, as returned by ElGamal_Sign.
+static inline void
+write_elgamal_signature(std::vector<std::uint8_t>& out,
+                        const std::pair<std::pair<mpz_class, mpz_class>,
+                                        std::pair<mpz_class, mpz_class>>& signature)
+{
+    Writer writer(out);
+    writer.begin(Type::ElGamal_Signature);
+    writer.number(signature.first.first);
+    writer.number(signature.first.second);
+    writer.number(signature.second.first);
+    writer.number(signature.second.second);
+}
+
+static inline bool
+read_elgamal_signature(Reader& reader,
+                       std::pair<std::pair<mpz_class, mpz_class>,
+                                 std::pair<mpz_class, mpz_class>>& signature)
+{
+    return reader.begin(Type::ElGamal_Signature) &&
+           reader.number(signature.first.first) &&
+           reader.number(signature.first.second) &&
+           reader.number(signature.second.first) &&
+           reader.number(signature.second.second);
+}
+
+// Elliptic curve point {x, y}.
+static inline void
+write_ec_point(std::vector<std::uint8_t>& out, const std::pair<mpz_class, mpz_class>& point)
+{
+    Writer writer(out);
+    writer.begin(Type::EC_Point);
+    writer.number(point.first);
+    writer.number(point.second);
+}
+
+static inline bool
+read_ec_point(Reader& reader, std::pair<mpz_class, mpz_class>& point)
+{
+    return reader.begin(Type::EC_Point) &&
+           reader.number(point.first) &&
+           reader.number(point.second);
+}
+
+// Compressed elliptic curve point {x, y odd}, as returned by math::Compress_point_ECC.
+// The y parity is a word so that a reader can reject anything but 0 or 1.
+static inline void
+write_ec_point_compressed(std::vector<std::uint8_t>& out, const std::pair<mpz_class, bool>& point)
+{
+    Writer writer(out);
+    writer.begin(Type::EC_Point_Compressed);
+    writer.number(point.first);
+    writer.word(point.second ? 1 : 0);
+}
+
+static inline bool
+read_ec_point_compressed(Reader& reader, std::pair<mpz_class, bool>& point)
+{
+    std::uint64_t odd = 0;
+    if (!reader.begin(Type::EC_Point_Compressed) ||
+        !reader.number(point.first) ||
+        !reader.word(odd) ||
+        odd > 1)
+    {
+        return false;
+    }
+
+    point.second = odd == 1;
+    return true;
+}
+
+} // namespace serial
+} // namespace crypto
+#endif // SERIAL_UTILS_HPP